@@ -8,6 +8,7 @@
 #include <fstream>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 using json = nlohmann::ordered_json;
@@ -18,9 +19,13 @@ enum class RelocationType {
     R_X86_64_PC32, // 32-bit PC-relative addressing
     R_X86_64_64, // 64-bit absolute addressing
     R_X86_64_32S, // 32-bit signed absolute addressing
-    R_X86_64_GOTPCREL // 32-bit PC-relative GOT address
+    R_X86_64_GOTPCREL, // 32-bit PC-relative GOT address
+    R_X86_64_GOTPCRELX // 32-bit PC-relative GOT address, relaxable (GOTPCRELX / REX_GOTPCRELX)
 };
 
+// Number of RelocationType values, for tables indexed by type (keep R_X86_64_GOTPCRELX the last enumerator)
+constexpr size_t RELOC_TYPE_COUNT = static_cast<size_t>(RelocationType::R_X86_64_GOTPCRELX) + 1;
+
 // Relocation entry
 struct Relocation {
     RelocationType type;
@@ -64,6 +69,8 @@ enum class SHF { // Section Header Flags
     WRITE = 2, // Writable
     EXEC = 4, // Executable
     NOBITS = 8, // Takes no space in file (like BSS)
+    MERGE = 16, // Entries of entsize bytes may be merged (SHF_MERGE)
+    STRINGS = 32, // Entries are null-terminated strings (SHF_STRINGS)
 };
 
 // ================= PHF (Program Header Flags) =================
@@ -138,6 +145,8 @@ struct SectionHeader {
     uint64_t addr; // Virtual address
     uint64_t offset; // File offset
     uint64_t size; // Section size
+    uint64_t addralign = 1; // Required alignment of addr (sh_addralign, a power of two)
+    uint64_t entsize = 0; // Size of each entry for SHF_MERGE sections (sh_entsize), 0 otherwise
 };
 
 struct ProgramHeader {
@@ -224,6 +233,8 @@ public:
             shdr_json["addr"] = shdr.addr;
             shdr_json["offset"] = shdr.offset;
             shdr_json["size"] = shdr.size;
+            shdr_json["addralign"] = shdr.addralign;
+            shdr_json["entsize"] = shdr.entsize;
             shdrs_json.push_back(shdr_json);
         }
         result["shdrs"] = shdrs_json;
@@ -256,6 +267,10 @@ inline std::vector<uint8_t> generate_plt_stub(int32_t got_offset)
     return stub;
 }
 
+class ThreadPool; // Work-stealing thread pool (see thread_pool.hpp)
+class TimeTrace; // Phase timings for --time-trace (see time_trace.hpp)
+struct LinkStats; // Counters for --stats (see link_stats.hpp)
+
 // Core functions that we provide
 FLEObject load_fle(const std::string& filename); // Load FLE file into memory
 void FLE_cc(const std::vector<std::string>& args); // Compile source files to FLE
@@ -264,6 +279,8 @@ void FLE_cc(const std::vector<std::string>& args); // Compile source files to FL
 /**
  * Display the contents of an FLE object file
  * @param obj The FLE object to display
+ * @param writer Receives the formatted sections
+ * @param pool If not null, sections are formatted in parallel on this pool
  *
  * Expected output format:
  * Section .text:
@@ -273,7 +290,7 @@ void FLE_cc(const std::vector<std::string>& args); // Compile source files to FL
  * Relocations:
  *   0x0010: helper_func - 📍
  */
-void FLE_objdump(const FLEObject& obj, FLEWriter& writer);
+void FLE_objdump(const FLEObject& obj, FLEWriter& writer, ThreadPool* pool = nullptr);
 
 /**
  * Display the symbol table of an FLE object
@@ -293,20 +310,53 @@ void FLE_nm(const FLEObject& obj);
  */
 void FLE_exec(const FLEObject& obj);
 
+// 调用图中的一条边：caller 调用 callee 的次数（或采样到的次数）
+struct CallGraphEdge {
+    std::string caller;
+    std::string callee;
+    uint64_t weight;
+};
+
 struct LinkerOptions {
     std::string outputFile = "a.out"; // 输出文件名 (用于设置 .so 的 name 属性)
     bool shared = false; // 是否生成共享库 (-shared)
     std::string entryPoint = "_start"; // 入口点名称 (默认为 _start)
     bool is_static = false; // 是否强制静态链接 (-static)
+    bool gc_sections = false; // 回收没有被引用的输入节 (--gc-sections)
+    bool print_gc_sections = false; // 列出被回收的节 (--print-gc-sections)
+    int optimize = 1; // 链接时优化级别 (-O0 不合并，-O1 合并相同的字符串和常量，-O2 字符串还做尾部合并)
+    std::string icf = "none"; // 相同代码折叠 (--icf=none|safe|all)
+    std::vector<std::string> symbol_ordering; // 这些符号所在的输入节按此顺序排在最前面 (--symbol-ordering-file)
+    std::vector<CallGraphEdge> call_graph; // 按调用图聚类排列代码 (--call-graph-ordering-file)
+    uint64_t align_functions = 1; // .text 输入节至少按 N 字节对齐，有排序文件时只对齐排在前面的热点节 (--align-functions=N)
+    bool compact_segments = false; // 按权限把输出节归成 RX/R/RW 三个段，只有段边界按页对齐 (--compact-segments)
+    size_t threads = 0; // 线程总数（含主线程），0 表示使用所有核心 (--threads=N)
+    ThreadPool* pool = nullptr; // 驱动程序建好的共享线程池，为空时 FLE_ld 按 threads 自己建一个
+    std::string map_file; // 链接映射文件，为空时不输出 (-Map=<file>)
+    TimeTrace* trace = nullptr; // 驱动程序建好的阶段计时记录，为空时不计时 (--time-trace)
+    LinkStats* stats = nullptr; // 链接统计，为空时不统计 (--stats)
+    bool strict_archive_order = false; // 静态库按命令行顺序各扫描一次，只有同组的能互相解析 (--strict-archive-order)
+    std::vector<std::pair<size_t, size_t>> archive_groups; // --start-group/--end-group 括起来的输入区间 [first, last)，下标对应输入顺序
+    bool incremental = false; // 增量链接 (--incremental)
+    uint64_t incremental_default_padding = 64; // 增量链接时每个输入节后预留的字节数
+    std::map<std::string, uint64_t> incremental_padding; // 按输出节覆盖预留字节数，如 .text -> 256
 };
 
+struct LinkLayout; // 链接布局（见 incremental.hpp）
+
 /**
  * Link multiple FLE objects into an executable or shared library
  * @param objects Vector of FLE objects to link
  * @param options Linker configuration options
+ * @param layout If not null, receives the layout and relocation index used by incremental linking
  * @return A new FLE object (type ".exe" or ".so")
  */
-FLEObject FLE_ld(const std::vector<FLEObject>& objects, const LinkerOptions& options);
+FLEObject FLE_ld(const std::vector<FLEObject>& objects, const LinkerOptions& options, LinkLayout* layout = nullptr);
+
+/**
+ * Same as above, but links objects owned elsewhere (e.g. the link server's input cache) without copying them
+ */
+FLEObject FLE_ld(const std::vector<const FLEObject*>& objects, const LinkerOptions& options, LinkLayout* layout = nullptr);
 
 /**
  * Read FLE object file
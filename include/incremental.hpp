@@ -0,0 +1,59 @@
+#pragma once
+
+#include "fle.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ================= 增量链接 =================
+//
+// 完整链接时 FLE_ld 把布局和重定位索引填进 LinkLayout，保存在输出文件旁边。
+// 下次链接只有少数目标文件变化、而且它们还放得进原来的槽位时，
+// 只重新拷贝这些文件的节、重做它们自己的重定位，
+// 再根据重定位索引修补引用了挪动过的符号的那些位置。
+
+struct LinkLayout {
+    static constexpr size_t NO_MEMBER = SIZE_MAX;
+
+    struct InputSection {
+        std::string name; // 输入节名
+        std::string output; // 所在输出节
+        uint64_t addr; // 运行时地址
+        uint64_t size; // 实际大小
+        uint64_t capacity; // 槽位大小（实际大小加上预留空间）
+    };
+
+    struct InputObject {
+        size_t input; // 命令行上的第几个输入
+        size_t member; // 静态库成员下标，直接给出的目标文件为 NO_MEMBER
+        std::vector<InputSection> sections; // 与目标文件的 shdrs 一一对应
+    };
+
+    // 一处对全局符号的引用
+    struct Fixup {
+        size_t object; // 引用所在的目标文件（objects 的下标）
+        uint64_t addr; // 被修改位置的运行时地址 P
+        RelocationType type;
+        int64_t addend;
+    };
+
+    struct SymbolInfo {
+        uint64_t addr; // 最终地址
+        size_t object; // 胜出的定义所在的目标文件（objects 的下标）
+    };
+
+    std::vector<InputObject> objects; // 按链接顺序
+    std::map<std::string, SymbolInfo> symbols; // 全局符号
+    std::map<std::string, std::pair<uint64_t, uint64_t>> external; // 外部符号 -> (PLT 地址, GOT 地址)
+    std::map<std::string, std::vector<Fixup>> fixups; // 全局符号 -> 引用它的位置
+};
+
+/**
+ * 增量链接：读取输出文件旁的链接状态，能原地修补就只处理变化的目标文件，
+ * 否则退回完整链接。输出文件和新的链接状态都由本函数写出。
+ * @param inputs 输入文件路径（-l 已解析成路径），顺序与命令行一致
+ * @param options 链接选项
+ */
+void FLE_ld_incremental(const std::vector<std::string>& inputs, const LinkerOptions& options);
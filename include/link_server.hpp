@@ -0,0 +1,69 @@
+#pragma once
+
+#include "fle.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ================= 链接服务器 =================
+//
+// ld-server 常驻后台，监听一个 Unix 套接字，把解析好的静态库（.fa）和共享库（.fso）留在内存里。
+// ld 启动时先试着连接它：连上了就把命令行和当前目录发过去，由服务器按同样的逻辑链接，
+// 再把退出码和输出原样带回来；连不上就在本进程里链接。
+//
+// 套接字路径取环境变量 FLE_LD_SERVER，没有时用 $XDG_RUNTIME_DIR/fle-ld/server.sock
+// （没有 XDG_RUNTIME_DIR 时用 /tmp/fle-ld-<uid>/server.sock），默认目录必须是自己的、权限为 0700；
+// FLE_LD_SERVER=off 时 ld 不找服务器。两端都用 SO_PEERCRED 确认对方是同一个用户。
+
+// 解析过的静态库和共享库，按绝对路径缓存。
+// 文件的修改时间和大小都没变就直接用；变了再比较内容哈希，内容也变了才重新解析
+class InputCache {
+public:
+    // 可以从多个线程同时调用。返回的对象由各次链接共享，不复制；缓存更新后旧对象在最后一个使用者放手时释放
+    std::shared_ptr<const FLEObject> load(const std::string& path);
+
+    struct Counters {
+        size_t hits = 0; // 直接用缓存
+        size_t rehashed = 0; // 修改时间变了但内容没变
+        size_t parsed = 0; // 重新解析（没缓存过，或内容变了）
+    };
+    Counters counters() const;
+
+private:
+    struct Entry {
+        std::filesystem::file_time_type mtime;
+        uintmax_t size;
+        uint64_t hash; // 文件内容的哈希
+        std::shared_ptr<const FLEObject> object;
+    };
+
+    mutable std::mutex mutex;
+    std::map<std::string, Entry> entries;
+    Counters stats;
+};
+
+/**
+ * ld 命令本身（见 main.cpp）
+ * @param args 命令行参数（不含程序名）
+ * @param cache 链接服务器的输入缓存，为空时每次都从文件解析
+ * @return 退出码
+ */
+int FLE_ld_main(const std::vector<std::string>& args, InputCache* cache = nullptr);
+
+/**
+ * 链接服务器在运行时把这次 ld 交给它
+ * @param args ld 的命令行参数
+ * @param status 服务器处理完时收到的退出码
+ * @return 服务器是否处理了这次链接；为 false 时调用者应在本进程里链接
+ */
+bool forward_to_link_server(const std::vector<std::string>& args, int& status);
+
+/**
+ * 运行链接服务器，直到收到 --stop 请求或 SIGINT/SIGTERM
+ * @param args --socket=<path> 指定套接字，--stop 让正在运行的服务器退出
+ */
+void FLE_ld_server(const std::vector<std::string>& args);
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "fle.hpp"
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ================= --stats =================
+//
+// 一次链接的规模和耗时：输入个数、拉入的静态库成员、各类符号和重定位的数量、
+// GOT/PLT 表项、各输出节字节数、各阶段耗时和峰值内存。
+// 文本格式给人看，JSON 格式（一行）给收集脚本用。
+
+inline const char* symbol_type_name(SymbolType type)
+{
+    switch (type) {
+    case SymbolType::LOCAL:
+        return "local";
+    case SymbolType::WEAK:
+        return "weak";
+    case SymbolType::GLOBAL:
+        return "global";
+    case SymbolType::UNDEFINED:
+        return "undefined";
+    }
+    return "unknown";
+}
+
+inline const char* relocation_type_name(RelocationType type)
+{
+    switch (type) {
+    case RelocationType::R_X86_64_32:
+        return "R_X86_64_32";
+    case RelocationType::R_X86_64_PC32:
+        return "R_X86_64_PC32";
+    case RelocationType::R_X86_64_64:
+        return "R_X86_64_64";
+    case RelocationType::R_X86_64_32S:
+        return "R_X86_64_32S";
+    case RelocationType::R_X86_64_GOTPCREL:
+        return "R_X86_64_GOTPCREL";
+    case RelocationType::R_X86_64_GOTPCRELX:
+        return "R_X86_64_GOTPCRELX";
+    }
+    return "unknown";
+}
+
+struct LinkStats {
+    static constexpr size_t SYMBOL_TYPES = static_cast<size_t>(SymbolType::UNDEFINED) + 1;
+    static constexpr size_t RELOCATION_TYPES = RELOC_TYPE_COUNT;
+
+    size_t inputs = 0; // 命令行上的输入文件
+    size_t objects = 0; // 参与链接的目标文件（含拉入的静态库成员）
+    size_t members_pulled = 0; // 从静态库拉入的成员
+    std::array<size_t, SYMBOL_TYPES> symbols {}; // 参与链接的目标文件里各类符号的个数，下标为 SymbolType
+    std::array<size_t, RELOCATION_TYPES> relocations {}; // 实际处理的重定位，下标为 RelocationType
+    size_t got_entries = 0;
+    size_t plt_entries = 0;
+    std::vector<std::pair<std::string, uint64_t>> section_bytes; // 输出节 -> 字节数，按节头顺序
+    std::vector<std::pair<std::string, uint64_t>> phases; // 阶段 -> 耗时（微秒），按开始顺序
+    uint64_t wall_us = 0; // 整个 ld 命令的耗时
+    long peak_rss_kb = 0; // getrusage 的 ru_maxrss
+
+    void print(std::ostream& out) const
+    {
+        char line[256];
+        auto row = [&](const char* label, uint64_t value) {
+            std::snprintf(line, sizeof(line), "  %-30s %12llu\n", label, static_cast<unsigned long long>(value));
+            out << line;
+        };
+        auto ms = [&](const char* label, uint64_t us) {
+            std::snprintf(line, sizeof(line), "  %-30s %12.3f\n", label, us / 1000.0);
+            out << line;
+        };
+
+        out << "Link statistics\n";
+        row("inputs loaded", inputs);
+        row("objects linked", objects);
+        row("archive members pulled", members_pulled);
+        out << "Symbols\n";
+        for (size_t i = 0; i < SYMBOL_TYPES; ++i) {
+            row(symbol_type_name(static_cast<SymbolType>(i)), symbols[i]);
+        }
+        out << "Relocations\n";
+        for (size_t i = 0; i < RELOCATION_TYPES; ++i) {
+            row(relocation_type_name(static_cast<RelocationType>(i)), relocations[i]);
+        }
+        out << "Synthesized entries\n";
+        row("GOT", got_entries);
+        row("PLT", plt_entries);
+        out << "Output section bytes\n";
+        for (const auto& [name, bytes] : section_bytes) {
+            row(name.c_str(), bytes);
+        }
+        out << "Wall time (ms)\n";
+        for (const auto& [name, us] : phases) {
+            ms(name.c_str(), us);
+        }
+        ms("(total)", wall_us);
+        out << "Memory\n";
+        row("peak RSS (KB)", peak_rss_kb);
+    }
+
+    json to_json() const
+    {
+        json j;
+        j["inputs"] = inputs;
+        j["objects"] = objects;
+        j["archive_members_pulled"] = members_pulled;
+        j["symbols"] = json::object();
+        for (size_t i = 0; i < SYMBOL_TYPES; ++i) {
+            j["symbols"][symbol_type_name(static_cast<SymbolType>(i))] = symbols[i];
+        }
+        j["relocations"] = json::object();
+        for (size_t i = 0; i < RELOCATION_TYPES; ++i) {
+            j["relocations"][relocation_type_name(static_cast<RelocationType>(i))] = relocations[i];
+        }
+        j["got_entries"] = got_entries;
+        j["plt_entries"] = plt_entries;
+        j["section_bytes"] = json::object();
+        for (const auto& [name, bytes] : section_bytes) {
+            j["section_bytes"][name] = bytes;
+        }
+        j["phase_us"] = json::object();
+        for (const auto& [name, us] : phases) {
+            j["phase_us"][name] = us;
+        }
+        j["wall_us"] = wall_us;
+        j["peak_rss_kb"] = peak_rss_kb;
+        return j;
+    }
+};
@@ -0,0 +1,225 @@
+#pragma once
+
+#include "fle.hpp"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// ================= 按类型分组的重定位（Struct-of-Arrays） =================
+//
+// Relocation 是 array-of-structs 且带一个 std::string，逐条处理时分支多、访存散。
+// RelocBatch 把同一类型的重定位按列存放，批量引擎对整组做 S + A / S + A - P，
+// 再用非对齐的小端写入落到输出缓冲区。
+
+struct RelocBatch {
+    std::vector<uint64_t> offset; // 在输出缓冲区中的偏移
+    std::vector<uint32_t> symbol_id; // 符号编号：符号地址表的下标
+    std::vector<int64_t> addend; // 加数 A
+
+    size_t size() const { return offset.size(); }
+    bool empty() const { return offset.empty(); }
+
+    void push(uint64_t off, uint32_t sym, int64_t a)
+    {
+        offset.push_back(off);
+        symbol_id.push_back(sym);
+        addend.push_back(a);
+    }
+
+    void clear()
+    {
+        offset.clear();
+        symbol_id.clear();
+        addend.clear();
+    }
+};
+
+// 一个输入节的全部重定位，按 RelocationType 分组
+struct RelocBatches {
+    std::array<RelocBatch, RELOC_TYPE_COUNT> by_type;
+
+    RelocBatch& operator[](RelocationType type) { return by_type[static_cast<size_t>(type)]; }
+    const RelocBatch& operator[](RelocationType type) const { return by_type[static_cast<size_t>(type)]; }
+
+    void clear()
+    {
+        for (auto& batch : by_type) {
+            batch.clear();
+        }
+    }
+};
+
+// 非对齐的小端写入
+inline void store_le32(uint8_t* p, uint32_t v)
+{
+    if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(p, &v, sizeof(v));
+    } else {
+        for (int i = 0; i < 4; ++i) {
+            p[i] = static_cast<uint8_t>(v >> (8 * i));
+        }
+    }
+}
+
+inline void store_le64(uint8_t* p, uint64_t v)
+{
+    if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(p, &v, sizeof(v));
+    } else {
+        for (int i = 0; i < 8; ++i) {
+            p[i] = static_cast<uint8_t>(v >> (8 * i));
+        }
+    }
+}
+
+// 先把符号地址按 symbol_id 收集出来，后面的算术循环就只剩连续访存
+inline void gather_symbols(const RelocBatch& batch, const uint64_t* sym_addr, uint64_t* S)
+{
+    const uint32_t* ids = batch.symbol_id.data();
+    for (size_t i = 0, n = batch.size(); i < n; ++i) {
+        S[i] = sym_addr[ids[i]];
+    }
+}
+
+// value[i] = S[i] + A[i]
+inline void compute_abs(const RelocBatch& batch, const uint64_t* S, uint64_t* value)
+{
+    const int64_t* A = batch.addend.data();
+    for (size_t i = 0, n = batch.size(); i < n; ++i) {
+        value[i] = S[i] + static_cast<uint64_t>(A[i]);
+    }
+}
+
+// value[i] = S[i] + A[i] - P[i]，其中 P[i] = base_addr + offset[i]
+inline void compute_pcrel(const RelocBatch& batch, const uint64_t* S, uint64_t base_addr, uint64_t* value)
+{
+    const int64_t* A = batch.addend.data();
+    const uint64_t* off = batch.offset.data();
+    for (size_t i = 0, n = batch.size(); i < n; ++i) {
+        value[i] = S[i] + static_cast<uint64_t>(A[i]) - (base_addr + off[i]);
+    }
+}
+
+inline void store_batch32(const RelocBatch& batch, const uint64_t* value, uint8_t* out)
+{
+    const uint64_t* off = batch.offset.data();
+    for (size_t i = 0, n = batch.size(); i < n; ++i) {
+        store_le32(out + off[i], static_cast<uint32_t>(value[i]));
+    }
+}
+
+inline void store_batch64(const RelocBatch& batch, const uint64_t* value, uint8_t* out)
+{
+    const uint64_t* off = batch.offset.data();
+    for (size_t i = 0, n = batch.size(); i < n; ++i) {
+        store_le64(out + off[i], value[i]);
+    }
+}
+
+/**
+ * 对一组同类型的重定位做批量计算并写回
+ * @param type 这一组的重定位类型
+ * @param batch 重定位（offset 相对于 out）
+ * @param sym_addr 符号地址表，按 symbol_id 索引
+ * @param base_addr out[0] 的运行时地址，用于计算 P
+ * @param out 输出缓冲区
+ * @param scratch 临时缓冲区，复用以避免反复分配
+ */
+inline void apply_reloc_batch(RelocationType type, const RelocBatch& batch, const uint64_t* sym_addr,
+    uint64_t base_addr, uint8_t* out, std::vector<uint64_t>& scratch)
+{
+    size_t n = batch.size();
+    if (n == 0) {
+        return;
+    }
+    scratch.resize(2 * n);
+    uint64_t* S = scratch.data();
+    uint64_t* value = scratch.data() + n;
+
+    gather_symbols(batch, sym_addr, S);
+    switch (type) {
+    case RelocationType::R_X86_64_64:
+        compute_abs(batch, S, value);
+        store_batch64(batch, value, out);
+        break;
+    case RelocationType::R_X86_64_32:
+    case RelocationType::R_X86_64_32S:
+        compute_abs(batch, S, value);
+        store_batch32(batch, value, out);
+        break;
+    case RelocationType::R_X86_64_PC32:
+    case RelocationType::R_X86_64_GOTPCREL:
+    case RelocationType::R_X86_64_GOTPCRELX:
+        compute_pcrel(batch, S, base_addr, value);
+        store_batch32(batch, value, out);
+        break;
+    }
+}
+
+// 依次处理所有分组；各组写入的位置互不重叠，顺序不影响结果
+inline void apply_reloc_batches(const RelocBatches& batches, const uint64_t* sym_addr,
+    uint64_t base_addr, uint8_t* out, std::vector<uint64_t>& scratch)
+{
+    for (size_t t = 0; t < RELOC_TYPE_COUNT; ++t) {
+        apply_reloc_batch(static_cast<RelocationType>(t), batches.by_type[t], sym_addr, base_addr, out, scratch);
+    }
+}
+
+// ================= GOTPCRELX 松弛 =================
+//
+// 目标就在本模块里定义时，经 GOT 的间接访问可以改写成直接访问（与 ld.lld 的做法相同）：
+//   mov foo@GOTPCREL(%rip), %reg   (8b /r)  ->  lea foo(%rip), %reg   (8d /r)
+//   call *foo@GOTPCREL(%rip)       (ff 15)  ->  addr32 call foo       (67 e8)
+//   jmp *foo@GOTPCREL(%rip)        (ff 25)  ->  jmp foo; nop          (e9 .. 90)
+// 改写后按 PC32 重定位到符号本身，不再需要 GOT 表项。
+// 只有 R_X86_64_GOTPCRELX 能这样改，汇编器用它表明前面是可以改写的指令。
+
+enum class GotRelax {
+    NONE,
+    LEA,
+    CALL,
+    JMP,
+};
+
+// field 指向 32 位位移字段，offset 是它在节中的偏移（前面要有操作码和 ModRM 两个字节）
+inline GotRelax gotpcrelx_relaxation(const uint8_t* field, uint64_t offset)
+{
+    if (offset < 2) {
+        return GotRelax::NONE;
+    }
+    uint8_t opcode = field[-2], modrm = field[-1];
+    if (opcode == 0x8b && (modrm & 0xc7) == 0x05) {
+        return GotRelax::LEA;
+    }
+    if (opcode == 0xff && modrm == 0x15) {
+        return GotRelax::CALL;
+    }
+    if (opcode == 0xff && modrm == 0x25) {
+        return GotRelax::JMP;
+    }
+    return GotRelax::NONE;
+}
+
+// 改写指令，返回之后 PC32 重定位的位置相对原位移字段的偏移（加数不变）
+inline int64_t relax_gotpcrelx(uint8_t* field, GotRelax kind)
+{
+    switch (kind) {
+    case GotRelax::LEA:
+        field[-2] = 0x8d;
+        return 0;
+    case GotRelax::CALL:
+        field[-2] = 0x67;
+        field[-1] = 0xe8;
+        return 0;
+    case GotRelax::JMP:
+        // jmp 的位移紧跟在 e9 后面，指令结束位置提前一个字节，末尾补 nop
+        field[-2] = 0xe9;
+        field[3] = 0x90;
+        return -1;
+    case GotRelax::NONE:
+        break;
+    }
+    return 0;
+}
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// ================= 符号名驻留 + 开放寻址符号表 =================
+//
+// 链接器里的符号名会被反复比较和查找。StringInterner 把每个名字映射成一个
+// 连续的编号，之后的符号表都以编号为键，查找时不再需要拼接或比较字符串。
+
+// FNV-1a
+inline uint64_t hash_name(std::string_view s)
+{
+    uint64_t h = 1469598103934665603ull;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// 名字 -> 编号，线性探测的开放寻址哈希表
+class StringInterner {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    StringInterner() { slots.assign(16, NONE); }
+
+    size_t size() const { return names.size(); }
+    std::string_view name(uint32_t id) const { return names[id]; }
+
+    // 查找名字的编号，不存在时返回 NONE
+    uint32_t find(std::string_view s) const { return find(s, hash_name(s)); }
+
+    uint32_t find(std::string_view s, uint64_t h) const
+    {
+        size_t mask = slots.size() - 1;
+        for (size_t i = h & mask;; i = (i + 1) & mask) {
+            uint32_t id = slots[i];
+            if (id == NONE) {
+                return NONE;
+            }
+            if (hashes[id] == h && names[id] == s) {
+                return id;
+            }
+        }
+    }
+
+    // 返回名字的编号，不存在则分配一个新的
+    uint32_t intern(std::string_view s) { return intern(s, hash_name(s)); }
+
+    uint32_t intern(std::string_view s, uint64_t h)
+    {
+        size_t mask = slots.size() - 1;
+        size_t i = h & mask;
+        for (;; i = (i + 1) & mask) {
+            uint32_t id = slots[i];
+            if (id == NONE) {
+                break;
+            }
+            if (hashes[id] == h && names[id] == s) {
+                return id;
+            }
+        }
+        uint32_t id = static_cast<uint32_t>(names.size());
+        names.emplace_back(s); // deque 扩容不移动已有元素，name() 返回的视图一直有效
+        hashes.push_back(h);
+        slots[i] = id;
+        if (2 * names.size() > slots.size()) {
+            grow();
+        }
+        return id;
+    }
+
+private:
+    void grow()
+    {
+        slots.assign(slots.size() * 2, NONE);
+        size_t mask = slots.size() - 1;
+        for (uint32_t id = 0; id < names.size(); ++id) {
+            size_t i = hashes[id] & mask;
+            while (slots[i] != NONE) {
+                i = (i + 1) & mask;
+            }
+            slots[i] = id;
+        }
+    }
+
+    std::deque<std::string> names;
+    std::vector<uint64_t> hashes; // 按编号存放，扩容时不必重新计算
+    std::vector<uint32_t> slots; // 编号，NONE 表示空槽
+};
+
+// 以名字编号为键的开放寻址哈希表（线性探测，只插入不删除）
+template <typename V>
+class IdHashMap {
+public:
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+
+    IdHashMap() = default;
+
+    size_t size() const { return count; }
+
+    V* find(uint32_t key)
+    {
+        if (slots.empty() || key == EMPTY) {
+            return nullptr;
+        }
+        size_t mask = slots.size() - 1;
+        for (size_t i = mix(key) & mask;; i = (i + 1) & mask) {
+            if (slots[i].first == key) {
+                return &slots[i].second;
+            }
+            if (slots[i].first == EMPTY) {
+                return nullptr;
+            }
+        }
+    }
+
+    const V* find(uint32_t key) const { return const_cast<IdHashMap*>(this)->find(key); }
+
+    // 返回键对应的值，不存在时插入默认值；second 表示是否新插入
+    std::pair<V*, bool> try_emplace(uint32_t key)
+    {
+        if (2 * (count + 1) > slots.size()) {
+            rehash(slots.empty() ? 16 : slots.size() * 2);
+        }
+        size_t mask = slots.size() - 1;
+        for (size_t i = mix(key) & mask;; i = (i + 1) & mask) {
+            if (slots[i].first == key) {
+                return { &slots[i].second, false };
+            }
+            if (slots[i].first == EMPTY) {
+                slots[i].first = key;
+                slots[i].second = V {};
+                ++count;
+                return { &slots[i].second, true };
+            }
+        }
+    }
+
+    // 按槽位顺序遍历所有表项（顺序与插入顺序无关）
+    template <typename F>
+    void for_each(F&& f) const
+    {
+        for (const auto& [key, value] : slots) {
+            if (key != EMPTY) {
+                f(key, value);
+            }
+        }
+    }
+
+private:
+    // 编号是连续的小整数，乘一个奇数打散后再取低位
+    static size_t mix(uint32_t key) { return static_cast<size_t>(key * 0x9E3779B97F4A7C15ull >> 16); }
+
+    void rehash(size_t capacity)
+    {
+        std::vector<std::pair<uint32_t, V>> old = std::move(slots);
+        slots.assign(capacity, { EMPTY, V {} });
+        count = 0;
+        for (auto& [key, value] : old) {
+            if (key != EMPTY) {
+                *try_emplace(key).first = std::move(value);
+            }
+        }
+    }
+
+    std::vector<std::pair<uint32_t, V>> slots;
+    size_t count = 0;
+};
+
+// ================= 按名字哈希分片 =================
+//
+// 并行构建符号表时按名字哈希把符号分到若干分片，每个分片只由一个线程处理，
+// 分片之间没有共享数据，不需要加锁。名字编号的低位是分片号，查找时直接定位到分片。
+
+constexpr uint32_t SYMBOL_SHARD_BITS = 6;
+constexpr size_t SYMBOL_SHARDS = size_t { 1 } << SYMBOL_SHARD_BITS;
+
+// 分片号取哈希的高位，StringInterner 的槽位用的是低位，两者互不相关
+inline size_t shard_of(uint64_t h) { return h >> (64 - SYMBOL_SHARD_BITS); }
+
+class ShardedStringInterner {
+public:
+    static constexpr uint32_t NONE = StringInterner::NONE;
+
+    size_t size() const
+    {
+        size_t n = 0;
+        for (const auto& shard : shards) {
+            n += shard.size();
+        }
+        return n;
+    }
+
+    std::string_view name(uint32_t id) const { return shards[id & (SYMBOL_SHARDS - 1)].name(id >> SYMBOL_SHARD_BITS); }
+
+    uint32_t find(std::string_view s) const { return find(s, hash_name(s)); }
+
+    uint32_t find(std::string_view s, uint64_t h) const
+    {
+        size_t shard = shard_of(h);
+        uint32_t local = shards[shard].find(s, h);
+        return local == NONE ? NONE : to_id(local, shard);
+    }
+
+    uint32_t intern(std::string_view s) { return intern(s, hash_name(s)); }
+
+    // 不同分片的名字可以由不同线程同时驻留
+    uint32_t intern(std::string_view s, uint64_t h)
+    {
+        size_t shard = shard_of(h);
+        return to_id(shards[shard].intern(s, h), shard);
+    }
+
+private:
+    static uint32_t to_id(uint32_t local, size_t shard) { return local << SYMBOL_SHARD_BITS | static_cast<uint32_t>(shard); }
+
+    std::array<StringInterner, SYMBOL_SHARDS> shards;
+};
+
+// 以 ShardedStringInterner 的编号为键，编号所在的分片各有一张表
+template <typename V>
+class ShardedIdHashMap {
+public:
+    size_t size() const
+    {
+        size_t n = 0;
+        for (const auto& shard : shards) {
+            n += shard.size();
+        }
+        return n;
+    }
+
+    V* find(uint32_t key) { return shards[key & (SYMBOL_SHARDS - 1)].find(key); }
+    const V* find(uint32_t key) const { return shards[key & (SYMBOL_SHARDS - 1)].find(key); }
+
+    // 分片号为 i 的表，只能由处理这个分片的线程写入
+    IdHashMap<V>& shard(size_t i) { return shards[i]; }
+
+    template <typename F>
+    void for_each(F&& f) const
+    {
+        for (const auto& shard : shards) {
+            shard.for_each(f);
+        }
+    }
+
+private:
+    std::array<IdHashMap<V>, SYMBOL_SHARDS> shards;
+};
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing 线程池
+// 每个工作线程有自己的任务队列：从自己的队头取任务，空闲时从别人的队尾偷任务。
+// 等待任务完成的线程（包括调用 parallel_for 的线程）也会帮忙执行任务，
+// 因此在任务内部再次调用 parallel_for 不会死锁。
+// 调用线程算作其中一个线程：ThreadPool(N) 只另外启动 N - 1 个工作线程。
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(size_t num_threads)
+        : num_threads(std::max<size_t>(num_threads, 1))
+    {
+        size_t num_workers = this->num_threads - 1;
+        // 没有工作线程时也留一个队列，提交的任务由调用线程执行
+        for (size_t i = 0; i < std::max<size_t>(num_workers, 1); ++i) {
+            queues.push_back(std::make_unique<WorkQueue>());
+        }
+        for (size_t i = 0; i < num_workers; ++i) {
+            workers.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stopping = true;
+        }
+        sleep_cv.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 线程总数，含调用线程
+    size_t size() const { return num_threads; }
+
+    // 提交一个任务，按轮转方式放进某个工作线程的队列
+    void submit(Task task)
+    {
+        size_t idx = next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+        {
+            std::lock_guard<std::mutex> lock(queues[idx]->mutex);
+            queues[idx]->tasks.push_back(std::move(task));
+            pending.fetch_add(1, std::memory_order_release);
+        }
+        // 空等一下 sleep_mutex：正在检查 pending 的工作线程要么已经看到新任务，要么已经睡下、能收到通知
+        { std::lock_guard<std::mutex> lock(sleep_mutex); }
+        sleep_cv.notify_one();
+    }
+
+    // 从任意队列里偷一个任务在当前线程执行，没有任务可做时返回 false
+    bool run_one()
+    {
+        Task task;
+        if (!steal(queues.size(), task)) {
+            return false;
+        }
+        task();
+        return true;
+    }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool pop_own(size_t self, Task& task)
+    {
+        auto& queue = *queues[self];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            return false;
+        }
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        pending.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // self == queues.size() 表示调用者不是工作线程
+    bool steal(size_t self, Task& task)
+    {
+        size_t n = queues.size();
+        size_t start = self < n ? self + 1 : 0;
+        for (size_t k = 0; k < n; ++k) {
+            size_t victim = (start + k) % n;
+            if (victim == self) {
+                continue;
+            }
+            auto& queue = *queues[victim];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) {
+                continue;
+            }
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            pending.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void worker_loop(size_t self)
+    {
+        while (true) {
+            Task task;
+            if (pop_own(self, task) || steal(self, task)) {
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            sleep_cv.wait(lock, [this] { return stopping || pending.load(std::memory_order_acquire) > 0; });
+            if (stopping && pending.load(std::memory_order_acquire) == 0) {
+                return;
+            }
+        }
+    }
+
+    size_t num_threads;
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> next_queue { 0 };
+
+    // 队列里的任务总数，只在持有对应队列的锁时增减，因此不会比队列里实际的任务少
+    std::atomic<size_t> pending { 0 };
+    std::mutex sleep_mutex;
+    std::condition_variable sleep_cv;
+    bool stopping = false;
+};
+
+/**
+ * 并行执行 body(i)，i ∈ [0, n)
+ * 下标被切成连续的若干块分给线程池，调用者也参与执行，没有任务可偷时睡眠等待剩下的块完成。
+ * 若有任务抛出异常，重新抛出下标最小的那个，保证报错结果与线程数无关。
+ * pool 为空或只有一个线程时退化为顺序执行。
+ */
+template <typename Body>
+void parallel_for(ThreadPool* pool, size_t n, Body&& body)
+{
+    if (pool == nullptr || pool->size() <= 1 || n <= 1) {
+        for (size_t i = 0; i < n; ++i) {
+            body(i);
+        }
+        return;
+    }
+
+    size_t num_chunks = std::min(n, pool->size() * 8);
+    size_t chunk_size = (n + num_chunks - 1) / num_chunks;
+    num_chunks = (n + chunk_size - 1) / chunk_size;
+
+    std::vector<std::exception_ptr> errors(num_chunks);
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+    size_t remaining = num_chunks;
+
+    for (size_t c = 0; c < num_chunks; ++c) {
+        pool->submit([&, c] {
+            size_t begin = c * chunk_size;
+            size_t end = std::min(n, begin + chunk_size);
+            try {
+                for (size_t i = begin; i < end; ++i) {
+                    body(i);
+                }
+            } catch (...) {
+                errors[c] = std::current_exception();
+            }
+            // 持锁通知：调用者拿到锁看到 remaining == 0 之前，done_cv 不会被销毁
+            std::lock_guard<std::mutex> lock(done_mutex);
+            if (--remaining == 0) {
+                done_cv.notify_all();
+            }
+        });
+    }
+
+    auto all_done = [&] {
+        std::lock_guard<std::mutex> lock(done_mutex);
+        return remaining == 0;
+    };
+    while (!all_done()) {
+        if (!pool->run_one()) {
+            // 剩下的块都已经在别的线程上运行
+            std::unique_lock<std::mutex> lock(done_mutex);
+            done_cv.wait(lock, [&] { return remaining == 0; });
+        }
+    }
+
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
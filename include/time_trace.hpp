@@ -0,0 +1,153 @@
+#pragma once
+
+#include "nlohmann/json.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// ================= --time-trace =================
+//
+// 记录链接各阶段的耗时，输出 Chrome trace（chrome://tracing、Perfetto 都能打开）。
+// 没开 --time-trace 时 TimeTrace 指针为空，TraceSpan 什么也不做，连时钟都不读。
+
+class TimeTrace {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Args = std::vector<std::pair<const char*, uint64_t>>;
+
+    TimeTrace()
+        : start(Clock::now())
+    {
+    }
+
+    // 可以从多个线程同时调用
+    void add(std::string name, std::string detail, Clock::time_point begin, Clock::time_point end, Args args)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto [it, inserted] = thread_ids.try_emplace(std::this_thread::get_id(), static_cast<uint32_t>(thread_ids.size()));
+        events.push_back({ std::move(name), std::move(detail), micros(begin), micros(end) - micros(begin), it->second, std::move(args) });
+    }
+
+    void write(const std::string& path) const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        nlohmann::ordered_json trace_events = nlohmann::ordered_json::array();
+        for (const auto& event : events) {
+            nlohmann::ordered_json e;
+            e["name"] = event.name;
+            e["cat"] = "ld";
+            e["ph"] = "X";
+            e["ts"] = event.ts;
+            e["dur"] = event.dur;
+            e["pid"] = 1;
+            e["tid"] = event.tid;
+            nlohmann::ordered_json args = nlohmann::ordered_json::object();
+            if (!event.detail.empty()) {
+                args["detail"] = event.detail;
+            }
+            for (const auto& [key, value] : event.args) {
+                args[key] = value;
+            }
+            e["args"] = args;
+            trace_events.push_back(e);
+        }
+        std::ofstream out(path);
+        if (!out) {
+            throw std::runtime_error("Cannot open time trace file: " + path);
+        }
+        out << nlohmann::ordered_json { { "traceEvents", trace_events }, { "displayTimeUnit", "ms" } }.dump() << "\n";
+    }
+
+    // 不带 detail 的区间（即各阶段）按名字累计耗时（微秒），按开始时间排序，供 --stats 使用
+    std::vector<std::pair<std::string, uint64_t>> phases() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<const Event*> sorted;
+        for (const auto& event : events) {
+            if (event.detail.empty()) {
+                sorted.push_back(&event);
+            }
+        }
+        std::stable_sort(sorted.begin(), sorted.end(), [](const Event* a, const Event* b) { return a->ts < b->ts; });
+        std::vector<std::pair<std::string, uint64_t>> result;
+        std::map<std::string, size_t> index;
+        for (const Event* event : sorted) {
+            auto [it, inserted] = index.try_emplace(event->name, result.size());
+            if (inserted) {
+                result.emplace_back(event->name, 0);
+            }
+            result[it->second].second += event->dur;
+        }
+        return result;
+    }
+
+private:
+    struct Event {
+        std::string name;
+        std::string detail; // 比如输入文件名
+        uint64_t ts; // 开始时间（微秒，从 TimeTrace 创建时算起）
+        uint64_t dur; // 持续时间（微秒）
+        uint32_t tid; // 线程编号，按第一次出现的顺序
+        Args args; // 计数：字节数、重定位数、符号数等
+    };
+
+    uint64_t micros(Clock::time_point t) const
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(t - start).count();
+    }
+
+    Clock::time_point start;
+    mutable std::mutex mutex;
+    std::vector<Event> events;
+    std::map<std::thread::id, uint32_t> thread_ids;
+};
+
+// 一段计时：构造时开始，end() 或析构时记入 trace
+class TraceSpan {
+public:
+    TraceSpan(TimeTrace* trace, std::string_view name, std::string_view detail = {})
+        : trace(trace)
+    {
+        if (trace) {
+            this->name = name;
+            this->detail = detail;
+            begin = TimeTrace::Clock::now();
+        }
+    }
+
+    ~TraceSpan() { end(); }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    void arg(const char* key, uint64_t value)
+    {
+        if (trace) {
+            args.emplace_back(key, value);
+        }
+    }
+
+    void end()
+    {
+        if (trace) {
+            trace->add(std::move(name), std::move(detail), begin, TimeTrace::Clock::now(), std::move(args));
+            trace = nullptr;
+        }
+    }
+
+private:
+    TimeTrace* trace;
+    std::string name;
+    std::string detail;
+    TimeTrace::Clock::time_point begin;
+    TimeTrace::Args args;
+};
@@ -10,6 +10,7 @@
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 
 using namespace std::string_literals;
 using namespace std::string_view_literals;
@@ -51,8 +52,8 @@ constexpr auto RELOCATION_FORMATS = std::array {
     std::pair { "R_X86_64_32"sv, RelocationFormat { ".abs"sv, 4 } },
     std::pair { "R_X86_64_32S"sv, RelocationFormat { ".abs32s"sv, 4 } },
     std::pair { "R_X86_64_GOTPCREL"sv, RelocationFormat { ".gotpcrel"sv, 4 } },
-    std::pair { "R_X86_64_GOTPCRELX"sv, RelocationFormat { ".gotpcrel"sv, 4 } },
-    std::pair { "R_X86_64_REX_GOTPCRELX"sv, RelocationFormat { ".gotpcrel"sv, 4 } }
+    std::pair { "R_X86_64_GOTPCRELX"sv, RelocationFormat { ".gotpcrelx"sv, 4 } },
+    std::pair { "R_X86_64_REX_GOTPCRELX"sv, RelocationFormat { ".gotpcrelx"sv, 4 } }
 };
 
 // 解析符号表
@@ -264,9 +265,38 @@ void FLE_cc(const std::vector<std::string>& options)
 
     // 处理每个节
     static const std::regex section_pattern {
-        R"(^\s*([0-9]+)\s+(\.(\w|\.)+)\s+([0-9a-fA-F]+)\s+.*$)"
+        R"(^\s*([0-9]+)\s+(\.(\w|\.)+)\s+([0-9a-fA-F]+)\s+.*\s2\*\*([0-9]+)$)"
     };
 
+    // objdump -h 不显示 SHF_MERGE/SHF_STRINGS 和 sh_entsize，从 readelf -S 里取：
+    //   [Nr] Name Type Address Off Size ES Flg Lk Inf Al（Flg 可能为空）
+    struct MergeInfo {
+        bool merge;
+        bool strings;
+        uint64_t entsize;
+    };
+    std::unordered_map<std::string, MergeInfo> merge_info;
+    for (const auto& line : splitlines(execute_command(fmt::format("readelf -S -W {}", binary)))) {
+        size_t bracket = line.find(']');
+        if (line.find('[') == std::string::npos || bracket == std::string::npos) {
+            continue;
+        }
+        std::vector<std::string> fields;
+        std::istringstream in(line.substr(bracket + 1));
+        for (std::string field; in >> field;) {
+            fields.push_back(field);
+        }
+        if (fields.size() != 10 || fields[0] == "Name") {
+            continue;
+        }
+        const std::string& flg = fields[6];
+        merge_info[fields[0]] = MergeInfo {
+            .merge = flg.find('M') != std::string::npos,
+            .strings = flg.find('S') != std::string::npos,
+            .entsize = std::stoull(fields[5], nullptr, 16),
+        };
+    }
+
     auto lines = splitlines(objdump_output);
     std::vector<SectionHeader> section_headers;
     std::vector<std::pair<std::string, bool>> sections_to_process;
@@ -292,6 +322,7 @@ void FLE_cc(const std::vector<std::string>& options)
             flags.push_back(trim(flag));
         }
         size_t size = std::stoul(match[4].str(), nullptr, 16);
+        uint64_t addralign = uint64_t { 1 } << std::stoul(match[5].str());
 
         // 检查是否需要处理该节
         if (!contains(flags, "ALLOC") || str_contains(section_name, "note.gnu.property") || size == 0) {
@@ -313,6 +344,16 @@ void FLE_cc(const std::vector<std::string>& options)
             sh_flags |= SHF::NOBITS;
         }
 
+        // 只有编译器标了 SHF_MERGE 的节才能合并，名字像 .rodata.str1 的普通变量不算
+        uint64_t entsize = 0;
+        if (auto info = merge_info.find(section_name); info != merge_info.end() && info->second.merge) {
+            sh_flags |= SHF::MERGE;
+            if (info->second.strings) {
+                sh_flags |= SHF::STRINGS;
+            }
+            entsize = info->second.entsize;
+        }
+
         // 创建节头
         section_headers.push_back(SectionHeader {
             .name = section_name,
@@ -321,6 +362,8 @@ void FLE_cc(const std::vector<std::string>& options)
             .addr = 0,
             .offset = current_offset,
             .size = size,
+            .addralign = addralign,
+            .entsize = entsize,
         });
 
         current_offset += size;
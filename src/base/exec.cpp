@@ -1,5 +1,6 @@
 #include "fle.hpp"
 #include "string_utils.hpp"
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <cstring>
@@ -110,6 +111,43 @@ void scan_dependencies_recursive(const std::string& filename)
     }
 }
 
+// Copy the sections of a freshly mapped segment into place and record their runtime addresses.
+// With section headers a segment may hold several sections (ld --compact-segments packs
+// .text and .plt into one RX segment, for example); without them the segment is the
+// section of the same name.
+void load_segment(const FLEObject& obj, const ProgramHeader& phdr, uint64_t load_base,
+    std::map<std::string, uint64_t>& section_addrs)
+{
+    uint8_t* segment = reinterpret_cast<uint8_t*>(load_base + phdr.vaddr);
+    bool found = false;
+    for (const auto& shdr : obj.shdrs) {
+        if (shdr.addr < phdr.vaddr || shdr.addr >= phdr.vaddr + phdr.size)
+            continue;
+        auto it = obj.sections.find(shdr.name);
+        if (it == obj.sections.end())
+            continue;
+        found = true;
+        section_addrs[shdr.name] = load_base + shdr.addr;
+        // NOBITS sections are already zero-filled by the anonymous mapping
+        if (shdr.type == 8)
+            continue;
+        size_t size = std::min<uint64_t>(it->second.data.size(), phdr.vaddr + phdr.size - shdr.addr);
+        memcpy(segment + (shdr.addr - phdr.vaddr), it->second.data.data(), size);
+    }
+    if (found)
+        return;
+
+    auto it = obj.sections.find(phdr.name);
+    if (it == obj.sections.end()) {
+        throw std::runtime_error("Section data not found for segment: " + phdr.name);
+    }
+    // Skip BSS copying
+    if (phdr.name != ".bss" && !starts_with(phdr.name, ".bss.")) {
+        memcpy(segment, it->second.data.data(), std::min<uint64_t>(it->second.data.size(), phdr.size));
+    }
+    section_addrs[phdr.name] = load_base + phdr.vaddr;
+}
+
 // Helper to resolve a symbol across all loaded modules
 uint64_t resolve_symbol(const std::string& name)
 {
@@ -272,24 +310,8 @@ void load_module_recursive(const std::string& filename)
             throw std::runtime_error("Failed to map segment " + phdr.name);
         }
 
-        // Copy section data
-        auto it = obj.sections.find(phdr.name);
-        if (it != obj.sections.end()) {
-            // Skip BSS copying
-            if (phdr.name != ".bss" && !starts_with(phdr.name, ".bss.")) {
-                if (it->second.data.size() > phdr.size) {
-                    // Should not happen if FLE is valid, but safety check
-                    memcpy(target_addr, it->second.data.data(), phdr.size);
-                } else {
-                    memcpy(target_addr, it->second.data.data(), it->second.data.size());
-                }
-            }
-        } else {
-            throw std::runtime_error("Section data not found for segment: " + phdr.name);
-        }
-
-        // Record section address
-        mod.section_addrs[phdr.name] = (uint64_t)target_addr;
+        // Copy section data and record section addresses
+        load_segment(obj, phdr, mod.load_base, mod.section_addrs);
     }
 
     // Add to specific list location (Global symbol resolution order)
@@ -347,16 +369,7 @@ void FLE_exec(const FLEObject& obj)
             throw std::runtime_error(std::string("mmap failed: ") + strerror(errno));
         }
 
-        auto it = obj.sections.find(phdr.name);
-        if (it == obj.sections.end()) {
-            throw std::runtime_error("Section not found: " + phdr.name);
-        }
-
-        if (phdr.name != ".bss" && !starts_with(phdr.name, ".bss.")) {
-            memcpy(addr, it->second.data.data(), phdr.size);
-        }
-
-        main_mod.section_addrs[phdr.name] = phdr.vaddr;
+        load_segment(obj, phdr, 0, main_mod.section_addrs);
     }
 
     loaded_modules.push_back(main_mod);
@@ -401,6 +414,7 @@ void FLE_exec(const FLEObject& obj)
                 *(uint32_t*)reloc_addr = (uint32_t)(sym_addr + reloc.addend - reloc_addr);
                 break;
             case RelocationType::R_X86_64_GOTPCREL:
+            case RelocationType::R_X86_64_GOTPCRELX:
                 *(uint32_t*)reloc_addr = (uint32_t)(sym_addr + reloc.addend - reloc_addr);
                 break;
             }
@@ -452,6 +466,7 @@ void FLE_exec(const FLEObject& obj)
                     *(uint32_t*)reloc_addr = (uint32_t)(sym_addr + reloc.addend - reloc_addr);
                     break;
                 case RelocationType::R_X86_64_GOTPCREL:
+                case RelocationType::R_X86_64_GOTPCRELX:
                     *(uint32_t*)reloc_addr = (uint32_t)(sym_addr + reloc.addend - reloc_addr);
                     break;
                 }
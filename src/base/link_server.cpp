@@ -0,0 +1,404 @@
+#include "link_server.hpp"
+#include "argparse.hpp"
+#include "symbol_table.hpp"
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string read_file(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// 默认套接字所在的目录：只有自己能进的 $XDG_RUNTIME_DIR/fle-ld，没有 XDG_RUNTIME_DIR 时用 /tmp/fle-ld-<uid>
+std::string default_socket_dir()
+{
+    const char* runtime = std::getenv("XDG_RUNTIME_DIR");
+    if (runtime && *runtime) {
+        return std::string(runtime) + "/fle-ld";
+    }
+    return "/tmp/fle-ld-" + std::to_string(getuid());
+}
+
+std::string default_socket_path()
+{
+    const char* env = std::getenv("FLE_LD_SERVER");
+    if (env && *env) {
+        return env;
+    }
+    return default_socket_dir() + "/server.sock";
+}
+
+// 目录必须是自己的、权限为 0700 的真目录（不是符号链接），否则别人可以抢先在里面放套接字
+bool is_private_dir(const std::string& dir)
+{
+    struct stat st;
+    return lstat(dir.c_str(), &st) == 0 && S_ISDIR(st.st_mode) && st.st_uid == getuid() && (st.st_mode & 0777) == 0700;
+}
+
+bool in_default_dir(const std::string& path)
+{
+    return fs::path(path).parent_path().lexically_normal() == fs::path(default_socket_dir()).lexically_normal();
+}
+
+// 服务器用默认路径时先建好默认目录
+void make_private_dir(const std::string& dir)
+{
+    if (mkdir(dir.c_str(), 0700) < 0 && errno != EEXIST) {
+        throw std::runtime_error("Cannot create " + dir + ": " + std::strerror(errno));
+    }
+    if (!is_private_dir(dir)) {
+        throw std::runtime_error(dir + " must be a directory owned by the current user with mode 0700");
+    }
+}
+
+// 套接字另一端的进程是否属于当前用户
+bool peer_is_self(int fd)
+{
+    ucred cred {};
+    socklen_t len = sizeof(cred);
+    return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0 && cred.uid == getuid();
+}
+
+sockaddr_un socket_address(const std::string& path)
+{
+    sockaddr_un addr {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Socket path too long: " + path);
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return addr;
+}
+
+// 连不上、或者在听的不是当前用户的进程时返回 -1
+int connect_to(const std::string& path)
+{
+    if (path.size() >= sizeof(sockaddr_un::sun_path)) {
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    sockaddr_un addr = socket_address(path);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    // 命令行、当前目录和输出路径只交给自己的服务器
+    if (!peer_is_self(fd)) {
+        std::cerr << "Warning: ignoring " << path << ", it is served by another user" << std::endl;
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// 每条消息是 8 字节长度加上 JSON 文本。长度超过上限的按坏消息处理，免得一个乱发的客户端让服务器分配不了内存
+constexpr uint64_t MAX_MESSAGE_SIZE = uint64_t { 64 } << 20;
+
+// 服务器等客户端收发一条消息的最长时间，免得一个不说话的客户端挡住后面所有链接
+constexpr int CLIENT_TIMEOUT_SECONDS = 5;
+
+bool send_message(int fd, const json& message)
+{
+    std::string payload = message.dump(-1, ' ', false, json::error_handler_t::replace);
+    uint64_t size = payload.size();
+    std::string buffer(reinterpret_cast<const char*>(&size), sizeof(size));
+    buffer += payload;
+    for (size_t sent = 0; sent < buffer.size();) {
+        ssize_t n = send(fd, buffer.data() + sent, buffer.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        sent += n;
+    }
+    return true;
+}
+
+bool receive_exactly(int fd, char* data, size_t size)
+{
+    for (size_t got = 0; got < size;) {
+        ssize_t n = recv(fd, data + got, size - got, 0);
+        if (n <= 0) {
+            return false;
+        }
+        got += n;
+    }
+    return true;
+}
+
+bool receive_message(int fd, json& message)
+{
+    uint64_t size;
+    if (!receive_exactly(fd, reinterpret_cast<char*>(&size), sizeof(size)) || size > MAX_MESSAGE_SIZE) {
+        return false;
+    }
+    std::string payload(size, '\0');
+    if (!receive_exactly(fd, payload.data(), size)) {
+        return false;
+    }
+    message = json::parse(payload, nullptr, false);
+    return !message.is_discarded();
+}
+
+// 当前可执行文件的路径和修改时间。
+// fle_base 重新编译后，旧服务器的链接逻辑可能已经过时，这时让 ld 在本进程里链接
+json executable_identity()
+{
+    std::error_code ec;
+    fs::path exe = fs::read_symlink("/proc/self/exe", ec);
+    auto time = fs::last_write_time(exe, ec);
+    return { exe.string(), static_cast<int64_t>(time.time_since_epoch().count()) };
+}
+
+// 在服务器进程里按 ld 命令行的语义链接：切到客户端的当前目录，截获标准输出和标准错误
+json serve_link(const json& request, InputCache& cache)
+{
+    std::ostringstream out, err;
+    std::streambuf* old_out = std::cout.rdbuf(out.rdbuf());
+    std::streambuf* old_err = std::cerr.rdbuf(err.rdbuf());
+    std::error_code ec;
+    fs::path old_cwd = fs::current_path(ec);
+
+    int status;
+    try {
+        fs::current_path(request.at("cwd").get<std::string>());
+        status = FLE_ld_main(request.at("args").get<std::vector<std::string>>(), &cache);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        status = 1;
+    }
+
+    std::cout.flush();
+    std::cerr.flush();
+    std::cout.rdbuf(old_out);
+    std::cerr.rdbuf(old_err);
+    fs::current_path(old_cwd, ec);
+    return { { "served", true }, { "status", status }, { "stdout", out.str() }, { "stderr", err.str() } };
+}
+
+// SIGINT/SIGTERM 时删掉套接字文件再退出
+char listening_path[sizeof(sockaddr_un::sun_path)];
+
+void stop_on_signal(int)
+{
+    unlink(listening_path);
+    _exit(0);
+}
+
+} // namespace
+
+std::shared_ptr<const FLEObject> InputCache::load(const std::string& path)
+{
+    std::error_code ec;
+    std::string key = fs::absolute(path, ec).lexically_normal().string();
+    auto mtime = fs::last_write_time(key, ec);
+    uintmax_t size = ec ? 0 : fs::file_size(key, ec);
+    if (ec) {
+        // 读不了的文件交给 load_fle 报错，保持和命令行一样的错误信息
+        return std::make_shared<const FLEObject>(load_fle(path));
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        if (it->second.mtime == mtime && it->second.size == size) {
+            ++stats.hits;
+            return it->second.object;
+        }
+        lock.unlock();
+        uint64_t hash = hash_name(read_file(key));
+        lock.lock();
+        it = entries.find(key);
+        if (it != entries.end() && it->second.hash == hash) {
+            it->second.mtime = mtime;
+            it->second.size = size;
+            ++stats.rehashed;
+            return it->second.object;
+        }
+    }
+    lock.unlock();
+
+    // 目标文件每次编辑都会变，只缓存静态库和共享库
+    auto object = std::make_shared<const FLEObject>(load_fle(path));
+    if (object->type != ".ar" && object->type != ".so") {
+        return object;
+    }
+    uint64_t hash = hash_name(read_file(key));
+    lock.lock();
+    entries.insert_or_assign(key, Entry { mtime, size, hash, object });
+    ++stats.parsed;
+    return object;
+}
+
+InputCache::Counters InputCache::counters() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+bool forward_to_link_server(const std::vector<std::string>& args, int& status)
+{
+    std::string path = default_socket_path();
+    if (path == "off") {
+        return false;
+    }
+    if (in_default_dir(path) && !is_private_dir(default_socket_dir())) {
+        return false;
+    }
+    int fd = connect_to(path);
+    if (fd < 0) {
+        return false;
+    }
+
+    std::error_code ec;
+    json request = { { "command", "link" }, { "exe", executable_identity() }, { "cwd", fs::current_path(ec).string() }, { "args", args } };
+    json response;
+    bool ok = send_message(fd, request) && receive_message(fd, response);
+    close(fd);
+    // 服务器中途退出或者拒绝（版本不同）时，在本进程里重新链接一次
+    if (!ok || !response.value("served", false)) {
+        return false;
+    }
+
+    std::cout << response["stdout"].get<std::string>() << std::flush;
+    std::cerr << response["stderr"].get<std::string>() << std::flush;
+    status = response["status"].get<int>();
+    return true;
+}
+
+void FLE_ld_server(const std::vector<std::string>& args)
+{
+    std::string path = default_socket_path();
+    bool stop = false;
+    ArgParser parser("ld-server");
+    parser.add_option(path, "--socket", "Unix socket to listen on (default: $FLE_LD_SERVER or $XDG_RUNTIME_DIR/fle-ld/server.sock)");
+    parser.add_flag(stop, "--stop", "Ask the running server to exit");
+    try {
+        parser.parse(args);
+    } catch (const ArgParser::HelpRequested&) {
+        return;
+    }
+    path = fs::absolute(path).string();
+
+    if (stop) {
+        int fd = connect_to(path);
+        if (fd < 0) {
+            throw std::runtime_error("No link server is listening on " + path);
+        }
+        json response;
+        bool ok = send_message(fd, { { "command", "stop" } }) && receive_message(fd, response);
+        close(fd);
+        if (!ok) {
+            throw std::runtime_error("Link server did not answer the stop request");
+        }
+        std::cout << "ld-server: stopped " << path << std::endl;
+        return;
+    }
+
+    if (in_default_dir(path)) {
+        make_private_dir(default_socket_dir());
+    }
+
+    // 套接字文件还在但没有服务器在听，是上次异常退出留下的
+    if (int fd = connect_to(path); fd >= 0) {
+        close(fd);
+        throw std::runtime_error("A link server is already listening on " + path);
+    }
+    std::error_code ec;
+    if (fs::exists(fs::symlink_status(path, ec))) {
+        if (!fs::is_socket(fs::symlink_status(path, ec))) {
+            throw std::runtime_error("Not a socket: " + path);
+        }
+        fs::remove(path, ec);
+    }
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        throw std::runtime_error("Cannot create socket: " + std::string(std::strerror(errno)));
+    }
+    sockaddr_un addr = socket_address(path);
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(listen_fd, 16) < 0) {
+        std::string reason = std::strerror(errno);
+        close(listen_fd);
+        throw std::runtime_error("Cannot listen on " + path + ": " + reason);
+    }
+    std::memcpy(listening_path, addr.sun_path, sizeof(listening_path));
+    std::signal(SIGINT, stop_on_signal);
+    std::signal(SIGTERM, stop_on_signal);
+    std::cout << "ld-server: listening on " << path << std::endl;
+
+    json self = executable_identity();
+    InputCache cache;
+    for (size_t served = 0;;) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        if (!peer_is_self(fd)) {
+            std::cout << "ld-server: refused a connection from another user" << std::endl;
+            close(fd);
+            continue;
+        }
+        timeval timeout { CLIENT_TIMEOUT_SECONDS, 0 };
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        // 一个连接出了任何问题都只断开这个连接，服务器继续服务后面的链接
+        bool stopping = false;
+        try {
+            json request, response;
+            if (!receive_message(fd, request) || !request.is_object()) {
+                close(fd);
+                continue;
+            }
+
+            std::string command = request.value("command", "");
+            if (command == "stop") {
+                send_message(fd, { { "served", true } });
+                stopping = true;
+            } else {
+                if (command != "link") {
+                    response = { { "served", false }, { "reason", "unknown command: " + command } };
+                } else if (request.value("exe", json()) != self) {
+                    response = { { "served", false }, { "reason", "ld-server is running a different build" } };
+                    std::cout << "ld-server: refused a link from a different build, restart the server" << std::endl;
+                } else {
+                    auto before = cache.counters();
+                    response = serve_link(request, cache);
+                    auto after = cache.counters();
+                    std::cout << "ld-server: link #" << ++served << " exited with " << response["status"].get<int>()
+                              << " (cached: " << after.hits - before.hits << " hits, " << after.rehashed - before.rehashed
+                              << " rehashed, " << after.parsed - before.parsed << " parsed)" << std::endl;
+                }
+                send_message(fd, response);
+            }
+        } catch (const std::exception& e) {
+            std::cout << "ld-server: dropped a connection: " << e.what() << std::endl;
+        }
+        close(fd);
+        if (stopping) {
+            break;
+        }
+    }
+
+    close(listen_fd);
+    unlink(path.c_str());
+    std::cout << "ld-server: exiting" << std::endl;
+}
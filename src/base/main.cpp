@@ -1,14 +1,24 @@
 #include "argparse.hpp"
 #include "fle.hpp"
+#include "incremental.hpp"
+#include "link_server.hpp"
+#include "link_stats.hpp"
 #include "string_utils.hpp"
+#include "thread_pool.hpp"
+#include "time_trace.hpp"
 #include <csignal>
 #include <cstdint>
+#include <chrono>
 #include <cstdio>
 #include <execinfo.h>
 #include <fstream>
 #include <iostream>
+#include <optional>
 #include <regex>
+#include <sstream>
 #include <string>
+#include <sys/resource.h>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -89,6 +99,8 @@ static void parse_section_headers(const json& j, FLEObject& obj)
             shdr.addr = shdr_json["addr"].get<uint64_t>();
             shdr.offset = shdr_json["offset"].get<uint64_t>();
             shdr.size = shdr_json["size"].get<uint64_t>();
+            shdr.addralign = shdr_json.value("addralign", uint64_t { 1 }); // 旧文件没有这一项
+            shdr.entsize = shdr_json.value("entsize", uint64_t { 0 });
             obj.shdrs.push_back(shdr);
         }
     }
@@ -107,6 +119,8 @@ static RelocationType parse_relocation_type(const std::string& type_str)
         return RelocationType::R_X86_64_32S;
     if (type_str == "gotpcrel")
         return RelocationType::R_X86_64_GOTPCREL;
+    if (type_str == "gotpcrelx")
+        return RelocationType::R_X86_64_GOTPCRELX;
     throw std::runtime_error("Invalid relocation type: " + type_str);
 }
 static int64_t parse_addend_literal(std::string literal)
@@ -241,7 +255,7 @@ static FLEObject parse_fle_from_json(const json& j, const std::string& name)
                 }
             } else if (prefix == "❓") {
                 std::string reloc_str = trim(content);
-                std::regex reloc_pattern(R"(\.(rel|abs64|abs|abs32s|gotpcrel|dynrel|dynabs64|dynabs32)\(([\w.@$]+)\s*([-+])\s*([0-9a-fA-FxX]+)\))");
+                std::regex reloc_pattern(R"(\.(rel|abs64|abs|abs32s|gotpcrelx|gotpcrel|dynrel|dynabs64|dynabs32)\(([\w.@$]+)\s*([-+])\s*([0-9a-fA-FxX]+)\))");
                 std::smatch match;
 
                 if (!std::regex_match(reloc_str, match, reloc_pattern)) {
@@ -436,6 +450,274 @@ struct InputItem {
     std::string value;
 };
 
+// ld 命令本身：命令行直接调用，链接服务器也用它处理转发来的请求
+int FLE_ld_main(const std::vector<std::string>& args, InputCache* cache)
+{
+    auto link_start = std::chrono::steady_clock::now();
+    LinkerOptions options;
+    std::vector<InputItem> ordered_inputs;
+    std::vector<std::string> lib_paths;
+
+    ArgParser parser("ld");
+
+    parser.add_option(options.outputFile, "-o, --output", "Output file");
+    parser.add_option(options.entryPoint, "-e, --entry", "Entry point");
+    parser.add_flag(options.shared, "-shared", "Create shared library");
+    parser.add_flag(options.is_static, "-static", "Static linking");
+    parser.add_multi_option(lib_paths, "-L", "Add library search path");
+    parser.add_flag(options.gc_sections, "--gc-sections", "Remove unreferenced input sections");
+    parser.add_flag(options.print_gc_sections, "--print-gc-sections", "List sections removed by --gc-sections");
+    parser.add_option_cb("-O", "Optimization level (0: no merging, 1: merge strings and constants, 2: also tail-merge strings)", [&](std::string value) {
+        if (value != "0" && value != "1" && value != "2") {
+            throw std::runtime_error("Invalid optimization level: " + value);
+        }
+        options.optimize = std::stoi(value);
+    });
+    parser.add_option_cb("--icf", "Fold identical code sections (none, safe, all)", [&](std::string value) {
+        if (value != "none" && value != "safe" && value != "all") {
+            throw std::runtime_error("Invalid --icf mode: " + value);
+        }
+        options.icf = value;
+    });
+    parser.add_option_cb("--symbol-ordering-file", "Lay out sections of the listed symbols first, in order", [&](std::string path) {
+        // 每行一个符号名，# 之后是注释
+        std::ifstream infile(path);
+        if (!infile) {
+            throw std::runtime_error("Cannot open symbol ordering file: " + path);
+        }
+        std::string line;
+        while (std::getline(infile, line)) {
+            std::string name = trim(line.substr(0, line.find('#')), " \t\r");
+            if (!name.empty()) {
+                options.symbol_ordering.push_back(name);
+            }
+        }
+    });
+    parser.add_option_cb("--call-graph-ordering-file", "Cluster sections by a weighted call graph (caller callee weight)", [&](std::string path) {
+        std::ifstream infile(path);
+        if (!infile) {
+            throw std::runtime_error("Cannot open call graph file: " + path);
+        }
+        std::string line;
+        for (size_t line_no = 1; std::getline(infile, line); ++line_no) {
+            std::string content = trim(line.substr(0, line.find('#')), " \t\r");
+            if (content.empty()) {
+                continue;
+            }
+            std::istringstream fields(content);
+            CallGraphEdge edge;
+            std::string extra;
+            if (!(fields >> edge.caller >> edge.callee >> edge.weight) || (fields >> extra)) {
+                throw std::runtime_error(path + ":" + std::to_string(line_no) + ": parse error: " + content);
+            }
+            options.call_graph.push_back(edge);
+        }
+    });
+    parser.add_option_cb("--align-functions", "Align .text input sections to N bytes (only the ordered hot ones with an ordering file)", [&](std::string value) {
+        // 对齐必须是 2 的幂
+        if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos || value.size() > 6) {
+            throw std::runtime_error("Invalid function alignment: " + value);
+        }
+        uint64_t align = std::stoull(value);
+        if (align == 0 || (align & (align - 1)) != 0) {
+            throw std::runtime_error("Function alignment must be a power of two: " + value);
+        }
+        options.align_functions = align;
+    });
+    parser.add_flag(options.compact_segments, "--compact-segments", "Pack sections into RX, R and RW segments, page-aligning only segment boundaries");
+    parser.add_option_cb("--threads", "Number of threads, including the main thread (default: all cores)", [&](std::string value) {
+        if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos || value.size() > 6 || std::stoul(value) == 0) {
+            throw std::runtime_error("Invalid thread count: " + value);
+        }
+        options.threads = std::stoul(value);
+    });
+    parser.add_flag(options.incremental, "--incremental", "Relink only changed objects when possible");
+    parser.add_option_cb("--incremental-padding", "Bytes reserved after each input section ([section=]N)", [&](std::string value) {
+        // N 设置默认值，.text=N 只设置某个输出节
+        size_t eq = value.find('=');
+        std::string number = eq == std::string::npos ? value : value.substr(eq + 1);
+        if (number.empty() || number.find_first_not_of("0123456789") != std::string::npos) {
+            throw std::runtime_error("Invalid incremental padding: " + value);
+        }
+        if (eq == std::string::npos) {
+            options.incremental_default_padding = std::stoull(number);
+        } else {
+            options.incremental_padding[value.substr(0, eq)] = std::stoull(number);
+        }
+    });
+
+    // 不带文件名时写到 <输出文件>.time-trace.json
+    bool time_trace = false;
+    std::string time_trace_file;
+    parser.add_flag_cb("--time-trace", "Write a Chrome trace of the link phases ([=file], default <output>.time-trace.json)", [&]() {
+        time_trace = true;
+    });
+    parser.add_option_cb("--time-trace", "", [&](std::string file) {
+        time_trace = true;
+        time_trace_file = file;
+    });
+    // --stats 打印给人看的表格，--stats=json 打印一行 JSON
+    std::string stats_format;
+    parser.add_flag_cb("--stats", "Print link statistics at the end ([=text|json])", [&]() {
+        stats_format = "text";
+    });
+    parser.add_option_cb("--stats", "", [&](std::string format) {
+        if (format != "text" && format != "json") {
+            throw std::runtime_error("Invalid stats format: " + format);
+        }
+        stats_format = format;
+    });
+    parser.add_option(options.map_file, "-Map", "Write a link map (sections, inputs, symbols, bytes per file) to the file");
+    // 默认所有静态库是一组；--strict-archive-order 时按命令行顺序扫描，只有组内的静态库能互相解析
+    parser.add_flag(options.strict_archive_order, "--strict-archive-order",
+        "Scan archives once in command-line order; only archives in the same group may refer back to each other");
+    size_t group_start = SIZE_MAX;
+    parser.add_flag_cb("--start-group", "Start a group of archives that may depend on each other", [&]() {
+        if (group_start != SIZE_MAX) {
+            throw std::runtime_error("Nested --start-group");
+        }
+        group_start = ordered_inputs.size();
+    });
+    parser.add_flag_cb("--end-group", "End a group of archives", [&]() {
+        if (group_start == SIZE_MAX) {
+            throw std::runtime_error("--end-group without --start-group");
+        }
+        options.archive_groups.emplace_back(group_start, ordered_inputs.size());
+        group_start = SIZE_MAX;
+    });
+
+    parser.add_option_cb("-l", "Link library", [&](std::string lib_name) {
+        ordered_inputs.push_back({ InputItem::Library, lib_name });
+    });
+
+    parser.on_positional([&](std::string file_path) {
+        ordered_inputs.push_back({ InputItem::File, file_path });
+    });
+
+    try {
+        parser.parse(args);
+    } catch (const ArgParser::HelpRequested&) {
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    if (group_start != SIZE_MAX) {
+        std::cerr << "Error: --start-group without --end-group\n";
+        return 1;
+    }
+
+    if (ordered_inputs.empty()) {
+        std::cerr << "Error: No inputs\n";
+        return 1;
+    }
+
+    std::vector<std::string> input_paths;
+    lib_paths.push_back("./");
+
+    for (const auto& item : ordered_inputs) {
+        if (item.type == InputItem::File) {
+            input_paths.push_back(item.value);
+        } else if (item.type == InputItem::Library) {
+            input_paths.push_back(find_library(item.value, lib_paths, options.is_static));
+        }
+    }
+
+    // 读入、链接、输出共用一个线程池
+    ThreadPool pool(options.threads ? options.threads : std::thread::hardware_concurrency());
+    options.pool = &pool;
+
+    // --stats 的各阶段耗时也取自 trace，只是不写文件
+    std::optional<TimeTrace> trace;
+    if (time_trace || !stats_format.empty()) {
+        options.trace = &trace.emplace();
+        if (time_trace_file.empty()) {
+            time_trace_file = options.outputFile + ".time-trace.json";
+        }
+    }
+    std::optional<LinkStats> stats;
+    if (!stats_format.empty()) {
+        options.stats = &stats.emplace();
+        stats->inputs = input_paths.size();
+    }
+
+    // 链接结束时补上输出节大小、耗时和峰值内存，再打印
+    auto report_stats = [&](const FLEObject& output) {
+        for (const auto& shdr : output.shdrs) {
+            stats->section_bytes.emplace_back(shdr.name, shdr.size);
+        }
+        stats->phases = trace->phases();
+        stats->wall_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - link_start).count();
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+            stats->peak_rss_kb = usage.ru_maxrss;
+        }
+        if (stats_format == "json") {
+            std::cout << stats->to_json().dump() << std::endl;
+        } else {
+            stats->print(std::cout);
+        }
+    };
+
+    if (options.incremental) {
+        {
+            TraceSpan span(options.trace, "incremental link");
+            FLE_ld_incremental(input_paths, options);
+        }
+        if (time_trace) {
+            trace->write(time_trace_file);
+        }
+        if (stats) {
+            // 原地修补时 FLE_ld 没有运行，只有输入、输出和耗时
+            report_stats(load_fle(options.outputFile));
+        }
+        return 0;
+    }
+
+    // 各输入文件独立解析，结果按命令行顺序存放；链接服务器缓存的输入直接共享，不复制
+    std::vector<std::shared_ptr<const FLEObject>> objects(input_paths.size());
+    TraceSpan load_span(options.trace, "input loading");
+    parallel_for(&pool, input_paths.size(), [&](size_t i) {
+        TraceSpan span(options.trace, "load", input_paths[i]);
+        objects[i] = cache ? cache->load(input_paths[i]) : std::make_shared<const FLEObject>(load_fle(input_paths[i]));
+        if (options.trace) {
+            span.arg("bytes", fs::file_size(input_paths[i]));
+            span.arg("symbols", objects[i]->symbols.size());
+            span.arg("members", objects[i]->members.size());
+        }
+    });
+    load_span.arg("inputs", input_paths.size());
+    load_span.end();
+
+    TraceSpan link_span(options.trace, "link");
+    std::vector<const FLEObject*> inputs;
+    for (const auto& object : objects) {
+        inputs.push_back(object.get());
+    }
+    FLEObject result = FLE_ld(inputs, options);
+    link_span.end();
+
+    TraceSpan write_span(options.trace, "output writing");
+    FLEWriter writer;
+    FLE_objdump(result, writer, &pool);
+    writer.write_to_file(options.outputFile);
+    if (options.trace) {
+        write_span.arg("bytes", fs::file_size(options.outputFile));
+        write_span.arg("sections", result.sections.size());
+    }
+    write_span.end();
+
+    if (time_trace) {
+        trace->write(time_trace_file);
+    }
+    if (stats) {
+        report_stats(result);
+    }
+
+    return 0;
+}
+
 int main(int argc, char* argv[])
 {
     // singlestack
@@ -455,12 +737,14 @@ int main(int argc, char* argv[])
         return 1;
     }
 
-    if (argc < 2) {
+    // 只有 ld-server 可以不带参数
+    if (argc < 2 && get_basename(argv[0]) != "ld-server") {
         std::cerr << "Usage: " << argv[0] << " <command> [args...]\n"
                   << "Commands:\n"
                   << "  objdump <input>                  Display contents of FLE file\n"
                   << "  nm <input>                       Display symbol table\n"
                   << "  ld [-o output] input1 input2...  Link FLE files (.fo/.fa/.fle)\n"
+                  << "  ld-server [--socket=path]        Serve ld requests, keeping archives and .fso in memory\n"
                   << "  exec <input.fle>                 Execute FLE file\n"
                   << "  cc [-o output.o] input.c...      Compile C files (outputs .fo)\n"
                   << "  ar <output.fa> <input.fo>...     Create static archive\n"
@@ -491,57 +775,14 @@ int main(int argc, char* argv[])
             }
             FLE_exec(load_fle(args[0]));
         } else if (tool == "FLE_ld") {
-            LinkerOptions options;
-            std::vector<InputItem> ordered_inputs;
-            std::vector<std::string> lib_paths;
-
-            ArgParser parser("ld");
-
-            parser.add_option(options.outputFile, "-o, --output", "Output file");
-            parser.add_option(options.entryPoint, "-e, --entry", "Entry point");
-            parser.add_flag(options.shared, "-shared", "Create shared library");
-            parser.add_flag(options.is_static, "-static", "Static linking");
-            parser.add_multi_option(lib_paths, "-L", "Add library search path");
-
-            parser.add_option_cb("-l", "Link library", [&](std::string lib_name) {
-                ordered_inputs.push_back({ InputItem::Library, lib_name });
-            });
-
-            parser.on_positional([&](std::string file_path) {
-                ordered_inputs.push_back({ InputItem::File, file_path });
-            });
-
-            try {
-                parser.parse(args);
-            } catch (const ArgParser::HelpRequested&) {
-                return 0;
-            } catch (const std::exception& e) {
-                std::cerr << "Error: " << e.what() << "\n";
-                return 1;
+            // 链接服务器在运行时交给它链接，否则在本进程里链接
+            int status;
+            if (forward_to_link_server(args, status)) {
+                return status;
             }
-
-            if (ordered_inputs.empty()) {
-                std::cerr << "Error: No inputs\n";
-                return 1;
-            }
-
-            std::vector<FLEObject> objects;
-            lib_paths.push_back("./");
-
-            for (const auto& item : ordered_inputs) {
-                if (item.type == InputItem::File) {
-                    objects.push_back(load_fle(item.value));
-                } else if (item.type == InputItem::Library) {
-                    std::string path = find_library(item.value, lib_paths, options.is_static);
-                    objects.push_back(load_fle(path));
-                }
-            }
-
-            FLEObject result = FLE_ld(objects, options);
-
-            FLEWriter writer;
-            FLE_objdump(result, writer);
-            writer.write_to_file(options.outputFile);
+            return FLE_ld_main(args);
+        } else if (tool == "FLE_ld-server") {
+            FLE_ld_server(args);
         } else if (tool == "FLE_cc") {
             FLE_cc(args);
         } else if (tool == "FLE_readfle") {
@@ -1,18 +1,23 @@
 #include "fle.hpp"
+#include "thread_pool.hpp"
 #include <algorithm>
 #include <cstdlib>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
 
-void FLE_objdump(const FLEObject& obj, FLEWriter& writer)
+void FLE_objdump(const FLEObject& obj, FLEWriter& writer, ThreadPool* pool)
 {
     writer.set_type(obj.type);
 
     // 如果是可执行文件，写入程序头和入口点
+    // 一个段里可能有多个节（ld --compact-segments），节头告诉加载器每个节在段里的位置
     if (obj.type == ".exe") {
         writer.write_program_headers(obj.phdrs);
         writer.write_entry(obj.entry);
+        if (!obj.shdrs.empty()) {
+            writer.write_section_headers(obj.shdrs);
+        }
     }
 
     // 如果是共享库，也写入程序头和节头
@@ -67,7 +72,7 @@ void FLE_objdump(const FLEObject& obj, FLEWriter& writer)
         }
     }
 
-    std::vector<std::tuple<std::string, size_t, FLESection>> sections;
+    std::vector<std::tuple<std::string, size_t, const FLESection*>> sections;
     for (const auto& pair : obj.sections) {
         const auto& name = pair.first;
         const auto& section = pair.second;
@@ -75,18 +80,21 @@ void FLE_objdump(const FLEObject& obj, FLEWriter& writer)
             return shdr.name == name;
         });
         if (shdr == obj.shdrs.end()) {
-            sections.push_back({ name, 0, section });
+            sections.push_back({ name, 0, &section });
             continue;
         }
-        sections.push_back({ name, shdr->offset, section });
+        sections.push_back({ name, shdr->offset, &section });
     }
     std::sort(sections.begin(), sections.end(), [](const auto& a, const auto& b) {
         return std::get<1>(a) < std::get<1>(b);
     });
 
-    // 写入所有段的内容
-    for (const auto& [name, _, section] : sections) {
-        writer.begin_section(name);
+    // 各节互不依赖，先并行格式化成行，再按顺序写入，输出与线程数无关
+    std::vector<std::vector<std::string>> section_lines(sections.size());
+    parallel_for(pool, sections.size(), [&](size_t sec_idx) {
+        const auto& [name, _, section_ptr] = sections[sec_idx];
+        const FLESection& section = *section_ptr;
+        auto& lines = section_lines[sec_idx];
 
         struct RelocForOutput {
             Relocation reloc;
@@ -131,6 +139,10 @@ void FLE_objdump(const FLEObject& obj, FLEWriter& writer)
                     if (!dynamic)
                         return ".gotpcrel";
                     break;
+                case RelocationType::R_X86_64_GOTPCRELX:
+                    if (!dynamic)
+                        return ".gotpcrelx";
+                    break;
                 }
                 throw std::runtime_error("Unsupported relocation type in objdump");
             };
@@ -166,7 +178,7 @@ void FLE_objdump(const FLEObject& obj, FLEWriter& writer)
                             [[unlikely]] throw std::runtime_error("unknown symbol type");
                         }
                         line += " " + std::to_string(sym.size) + " " + std::to_string(sym.offset);
-                        writer.write_line(line);
+                        lines.push_back(std::move(line));
                     }
                 }
             }
@@ -174,7 +186,7 @@ void FLE_objdump(const FLEObject& obj, FLEWriter& writer)
             auto reloc_it = reloc_index.find(pos);
             if (reloc_it != reloc_index.end()) {
                 for (const auto& reloc_entry : reloc_it->second) {
-                    writer.write_line(format_reloc(reloc_entry));
+                    lines.push_back(format_reloc(reloc_entry));
                     size_t reloc_size = (reloc_entry.reloc.type == RelocationType::R_X86_64_64) ? 8 : 4;
                     pos += reloc_size;
                 }
@@ -203,11 +215,18 @@ void FLE_objdump(const FLEObject& obj, FLEWriter& writer)
                         ss << " ";
                     }
                 }
-                writer.write_line(ss.str());
+                lines.push_back(ss.str());
                 pos += chunk_size;
             }
         }
+    });
 
+    // 写入所有段的内容
+    for (size_t sec_idx = 0; sec_idx < sections.size(); ++sec_idx) {
+        writer.begin_section(std::get<0>(sections[sec_idx]));
+        for (const auto& line : section_lines[sec_idx]) {
+            writer.write_line(line);
+        }
         writer.end_section();
     }
 }
@@ -72,6 +72,10 @@ void FLE_readfle(const FLEObject& obj)
             flags.push_back("EXEC");
         if (shdr.flags & SHF::NOBITS)
             flags.push_back("NOBITS");
+        if (shdr.flags & SHF::MERGE)
+            flags.push_back("MERGE");
+        if (shdr.flags & SHF::STRINGS)
+            flags.push_back("STRINGS");
 
         std::string flag_str;
         for (size_t i = 0; i < flags.size(); i++) {
@@ -159,6 +163,12 @@ void FLE_readfle(const FLEObject& obj)
                 case RelocationType::R_X86_64_32S:
                     type_str = "R_X86_64_32S";
                     break;
+                case RelocationType::R_X86_64_GOTPCREL:
+                    type_str = "R_X86_64_GOTPCREL";
+                    break;
+                case RelocationType::R_X86_64_GOTPCRELX:
+                    type_str = "R_X86_64_GOTPCRELX";
+                    break;
                 }
                 std::cout << std::left << std::setw(15) << type_str
                           << std::left << std::setw(max_symbol_name_len) << reloc.symbol
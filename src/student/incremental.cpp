@@ -0,0 +1,461 @@
+#include "fle.hpp"
+#include "incremental.hpp"
+#include "reloc_batch.hpp"
+#include "symbol_table.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+using namespace std;
+
+// 链接状态文件的格式版本，格式变了就加一，旧状态一律走完整链接
+static const int STATE_VERSION = 1;
+
+static string read_file(const string& path)
+{
+    ifstream in(path, ios::binary);
+    if (!in) return "";
+    return string(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+}
+
+static uint64_t hash_file(const string& path)
+{
+    return hash_name(read_file(path));
+}
+
+static string state_path(const LinkerOptions& options)
+{
+    return options.outputFile + ".incstate";
+}
+
+// 影响链接结果的选项，变了就不能沿用上次的布局
+static json options_to_json(const LinkerOptions& options)
+{
+    json j;
+    j["shared"] = options.shared;
+    j["entry"] = options.entryPoint;
+    j["gc_sections"] = options.gc_sections;
+    j["optimize"] = options.optimize;
+    j["icf"] = options.icf;
+    j["symbol_ordering"] = options.symbol_ordering;
+    j["compact_segments"] = options.compact_segments;
+    j["align_functions"] = options.align_functions;
+    j["strict_archive_order"] = options.strict_archive_order;
+    j["archive_groups"] = options.archive_groups;
+    j["call_graph"] = json::array();
+    for (const auto& edge : options.call_graph) j["call_graph"].push_back({edge.caller, edge.callee, edge.weight});
+    j["default_padding"] = options.incremental_default_padding;
+    j["padding"] = json::object();
+    for (const auto& [name, pad] : options.incremental_padding) j["padding"][name] = pad;
+    return j;
+}
+
+// 目标文件对外的样子：定义了哪些全局符号、引用了哪些未定义符号
+// 这两样不变，符号决议和静态库成员的选择就不变
+static json object_interface(const FLEObject& obj)
+{
+    json defined = json::array();
+    vector<string> undefined;
+    for (const auto& sym : obj.symbols)
+    {
+        if (sym.type == SymbolType::UNDEFINED) undefined.push_back(sym.name);
+        else if (sym.type != SymbolType::LOCAL) defined.push_back({sym.name, static_cast<int>(sym.type), sym.section});
+    }
+    sort(undefined.begin(), undefined.end());
+    json j;
+    j["defined"] = defined;
+    j["undefined"] = undefined;
+    return j;
+}
+
+// 按重定位类型计算并写入一处引用，与 FLE_ld 的批量引擎结果一致
+static void patch_reloc(uint8_t* p, RelocationType type, uint64_t S, int64_t A, uint64_t P)
+{
+    switch (type)
+    {
+        case RelocationType::R_X86_64_64:
+            store_le64(p, S + A);
+            break;
+        case RelocationType::R_X86_64_32:
+        case RelocationType::R_X86_64_32S:
+            store_le32(p, static_cast<uint32_t>(S + A));
+            break;
+        case RelocationType::R_X86_64_PC32:
+        case RelocationType::R_X86_64_GOTPCREL:
+        case RelocationType::R_X86_64_GOTPCRELX:
+            store_le32(p, static_cast<uint32_t>(S + A - P));
+            break;
+    }
+}
+
+static void write_output(const FLEObject& result, const string& path, ThreadPool* pool)
+{
+    FLEWriter writer;
+    FLE_objdump(result, writer, pool);
+    writer.write_to_file(path);
+}
+
+static json layout_to_json(const LinkLayout& layout)
+{
+    json objects = json::array();
+    for (const auto& obj : layout.objects)
+    {
+        json sections = json::array();
+        for (const auto& sec : obj.sections)
+        {
+            sections.push_back({sec.name, sec.output, sec.addr, sec.size, sec.capacity});
+        }
+        json j;
+        j["input"] = obj.input;
+        j["member"] = obj.member == LinkLayout::NO_MEMBER ? -1 : static_cast<int64_t>(obj.member);
+        j["sections"] = sections;
+        objects.push_back(j);
+    }
+
+    json symbols = json::object();
+    for (const auto& [name, info] : layout.symbols) symbols[name] = {info.addr, info.object};
+
+    json external = json::object();
+    for (const auto& [name, slots] : layout.external) external[name] = {slots.first, slots.second};
+
+    json fixups = json::object();
+    for (const auto& [name, list] : layout.fixups)
+    {
+        json arr = json::array();
+        for (const auto& f : list) arr.push_back({f.object, f.addr, static_cast<int>(f.type), f.addend});
+        fixups[name] = arr;
+    }
+
+    json j;
+    j["objects"] = objects;
+    j["symbols"] = symbols;
+    j["external"] = external;
+    j["fixups"] = fixups;
+    return j;
+}
+
+// 完整链接：加载全部输入，链接并记下布局
+static void full_link(const vector<string>& inputs, const vector<uint64_t>& hashes, const LinkerOptions& options)
+{
+    vector<FLEObject> objects(inputs.size());
+    parallel_for(options.pool, inputs.size(), [&](size_t i) { objects[i] = load_fle(inputs[i]); });
+
+    LinkLayout layout;
+    FLEObject result = FLE_ld(objects, options, &layout);
+    write_output(result, options.outputFile, options.pool);
+
+    json state = layout_to_json(layout);
+    state["version"] = STATE_VERSION;
+    state["options"] = options_to_json(options);
+    json in_files = json::array();
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        in_files.push_back({{"path", inputs[i]}, {"type", objects[i].type}, {"hash", hashes[i]}});
+    }
+    state["inputs"] = in_files;
+    for (size_t i = 0; i < layout.objects.size(); ++i)
+    {
+        const auto& origin = layout.objects[i];
+        const auto& obj = origin.member == LinkLayout::NO_MEMBER ? objects[origin.input] : objects[origin.input].members[origin.member];
+        state["objects"][i]["interface"] = object_interface(obj);
+    }
+    state["output_hash"] = hash_file(options.outputFile);
+
+    ofstream out(state_path(options));
+    out << state.dump() << endl;
+}
+
+// 尝试原地修补上次的输出，成功返回空串，否则返回需要完整链接的原因
+static string try_patch(json& state, const vector<string>& inputs, const vector<uint64_t>& hashes,
+                        const LinkerOptions& options)
+{
+    if (!state.contains("version") || state["version"] != STATE_VERSION) return "no usable link state";
+    if (state["options"] != options_to_json(options)) return "link options changed";
+    // 改动可能让别的节变得可达或不可达，回收结果只能重新算
+    if (options.gc_sections) return "--gc-sections needs a full link";
+    // 折叠关系同样取决于所有文件的内容
+    if (options.icf != "none") return "--icf needs a full link";
+    if (!options.map_file.empty()) return "-Map needs a full link";
+
+    auto& in_files = state["inputs"];
+    if (in_files.size() != inputs.size()) return "input files changed";
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        if (in_files[i]["path"] != inputs[i]) return "input files changed";
+    }
+    if (state["output_hash"] != hash_file(options.outputFile)) return "output file was modified";
+
+    vector<size_t> changed; // 变化的输入（命令行下标）
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        if (in_files[i]["hash"] != hashes[i]) changed.push_back(i);
+    }
+    if (changed.empty())
+    {
+        cerr << "incremental: output is up to date" << endl;
+        return "";
+    }
+
+    // 变化的输入必须是直接给出的目标文件；静态库和共享库一变就可能影响成员选择或外部符号
+    auto& objects = state["objects"];
+    unordered_map<size_t, size_t> obj_of_input; // 命令行下标 -> 目标文件下标
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        if (objects[i]["member"] == -1) obj_of_input[objects[i]["input"].get<size_t>()] = i;
+    }
+
+    struct ChangedObject
+    {
+        size_t obj_idx;
+        FLEObject obj;
+    };
+    vector<ChangedObject> changed_objs;
+    unordered_set<size_t> changed_set;
+    for (size_t input : changed)
+    {
+        if (in_files[input]["type"] != ".obj" || !obj_of_input.count(input))
+        {
+            return inputs[input] + " is not an object file";
+        }
+        size_t obj_idx = obj_of_input.at(input);
+        FLEObject obj = load_fle(inputs[input]);
+        if (obj.type != ".obj") return inputs[input] + " is not an object file";
+
+        // 定义和引用的符号变了，符号决议或静态库成员选择可能跟着变
+        const auto& interface = objects[obj_idx]["interface"];
+        json now = object_interface(obj);
+        if (now["defined"] != interface["defined"]) return inputs[input] + ": defined symbols changed";
+        if (now["undefined"] != interface["undefined"]) return inputs[input] + ": undefined symbols changed";
+
+        // 每个节都要放得进原来的槽位
+        const auto& sections = objects[obj_idx]["sections"];
+        if (sections.size() != obj.shdrs.size()) return inputs[input] + ": sections changed";
+        for (size_t i = 0; i < obj.shdrs.size(); ++i)
+        {
+            const auto& shdr = obj.shdrs[i];
+            if (sections[i][0] != shdr.name) return inputs[input] + ": sections changed";
+            uint64_t capacity = sections[i][4];
+            if (shdr.size > capacity)
+            {
+                return inputs[input] + ": " + shdr.name + " outgrew its slot (" + to_string(shdr.size) + " > " + to_string(capacity) + " bytes)";
+            }
+            uint64_t addr = sections[i][2];
+            if (shdr.addralign > 1 && addr % shdr.addralign != 0)
+            {
+                return inputs[input] + ": " + shdr.name + " needs " + to_string(shdr.addralign) + "-byte alignment";
+            }
+        }
+        changed_set.insert(obj_idx);
+        changed_objs.push_back({obj_idx, std::move(obj)});
+    }
+
+    // 上次的输出就是这次的底稿
+    FLEObject result = load_fle(options.outputFile);
+    // 输出节的 (名字, 地址, 大小)：有节头就按节头（一个段里可能有多个节），否则每个段就是同名的节
+    vector<tuple<string, uint64_t, uint64_t>> out_sections;
+    for (const auto& shdr : result.shdrs) out_sections.emplace_back(shdr.name, shdr.addr, shdr.size);
+    if (out_sections.empty())
+    {
+        for (const auto& phdr : result.phdrs) out_sections.emplace_back(phdr.name, phdr.vaddr, phdr.size);
+    }
+    auto image_at = [&](uint64_t addr) -> uint8_t*
+    {
+        for (const auto& [name, base, size] : out_sections)
+        {
+            if (addr < base || addr >= base + size) continue;
+            auto& data = result.sections.at(name).data;
+            if (addr - base >= data.size()) break;
+            return data.data() + (addr - base);
+        }
+        throw runtime_error("incremental: address 0x" + to_string(addr) + " is outside the output image");
+    };
+    auto section_base = [&](const string& name) -> uint64_t
+    {
+        for (const auto& [sec_name, base, size] : out_sections)
+        {
+            if (sec_name == name) return base;
+        }
+        throw runtime_error("incremental: output has no section " + name);
+    };
+
+    auto& symbols = state["symbols"];
+    auto& external = state["external"];
+    auto& fixups = state["fixups"];
+    unordered_map<string, size_t> result_sym_idx; // 输出符号表：名字 -> 下标
+    for (size_t i = 0; i < result.symbols.size(); ++i) result_sym_idx[result.symbols[i].name] = i;
+
+    // 先把变化的目标文件放回各自的槽位，更新它们定义的符号地址
+    unordered_map<string, uint64_t> moved; // 地址变了的全局符号 -> 新地址
+    for (auto& [obj_idx, obj] : changed_objs)
+    {
+        auto& sections = objects[obj_idx]["sections"];
+        for (size_t i = 0; i < obj.shdrs.size(); ++i)
+        {
+            const auto& shdr = obj.shdrs[i];
+            sections[i][3] = shdr.size;
+            if (shdr.type == 8 || sections[i][4] == 0) continue;
+            uint64_t addr = sections[i][2];
+            uint8_t* slot = image_at(addr);
+            const auto& data = obj.sections.at(shdr.name).data;
+            // 槽位剩下的部分与完整链接一样：代码填 int3，其余补 0
+            memset(slot, sections[i][1] == ".text" ? 0xcc : 0, sections[i][4].get<uint64_t>());
+            memcpy(slot, data.data(), min<size_t>(data.size(), shdr.size));
+        }
+
+        unordered_map<string, uint64_t> sec_addr;
+        for (size_t i = 0; i < obj.shdrs.size(); ++i) sec_addr[obj.shdrs[i].name] = sections[i][2];
+        for (const auto& sym : obj.symbols)
+        {
+            if (sym.type == SymbolType::UNDEFINED || sym.type == SymbolType::LOCAL) continue;
+            // 只有胜出的定义才决定符号地址（被强符号覆盖的弱符号不算）
+            if (!symbols.contains(sym.name)) continue;
+            auto& info = symbols[sym.name];
+            if (info[1] != obj_idx) continue;
+            uint64_t addr = sec_addr.at(sym.section) + sym.offset;
+            if (info[0] != addr) moved[sym.name] = addr;
+            info[0] = addr;
+
+            auto it = result_sym_idx.find(sym.name);
+            if (it != result_sym_idx.end())
+            {
+                auto& out_sym = result.symbols[it->second];
+                out_sym.offset = addr - section_base(out_sym.section);
+                out_sym.size = sym.size;
+            }
+        }
+    }
+
+    // 变化的目标文件原来的引用作废，下面重做重定位时重新记录
+    for (auto& [name, list] : fixups.items())
+    {
+        json kept = json::array();
+        for (auto& f : list)
+        {
+            if (!changed_set.count(f[0].get<size_t>())) kept.push_back(f);
+        }
+        list = kept;
+    }
+
+    // 重做变化的目标文件自己的重定位
+    size_t reapplied = 0;
+    for (auto& [obj_idx, obj] : changed_objs)
+    {
+        const auto& sections = objects[obj_idx]["sections"];
+        unordered_map<string, uint64_t> sec_addr;
+        for (size_t i = 0; i < obj.shdrs.size(); ++i) sec_addr[obj.shdrs[i].name] = sections[i][2];
+
+        // 局部符号同名保留第一个，与 FLE_ld 一致
+        unordered_map<string, uint64_t> locals;
+        for (const auto& sym : obj.symbols)
+        {
+            if (sym.type == SymbolType::LOCAL) locals.try_emplace(sym.name, sec_addr.at(sym.section) + sym.offset);
+        }
+
+        for (const auto& shdr : obj.shdrs)
+        {
+            if (shdr.type == 8) continue;
+            uint64_t base = sec_addr.at(shdr.name);
+            for (const auto& reloc : obj.sections.at(shdr.name).relocs)
+            {
+                uint64_t P = base + reloc.offset;
+                auto local_it = locals.find(reloc.symbol);
+                bool via_got = reloc.type == RelocationType::R_X86_64_GOTPCREL || reloc.type == RelocationType::R_X86_64_GOTPCRELX;
+                if (via_got && !external.contains(reloc.symbol) && (local_it != locals.end() || symbols.contains(reloc.symbol)))
+                {
+                    // 本模块定义的符号：能改写成直接访问的就地改写，要 GOT 槽位的只能重新完整链接
+                    GotRelax kind = reloc.type == RelocationType::R_X86_64_GOTPCRELX ? gotpcrelx_relaxation(image_at(P), reloc.offset) : GotRelax::NONE;
+                    if (kind == GotRelax::NONE) return "relocation needs a GOT slot: " + reloc.symbol;
+                    P += relax_gotpcrelx(image_at(P), kind);
+                    if (local_it != locals.end())
+                    {
+                        patch_reloc(image_at(P), RelocationType::R_X86_64_PC32, local_it->second, reloc.addend, P);
+                    }
+                    else
+                    {
+                        patch_reloc(image_at(P), RelocationType::R_X86_64_PC32, symbols[reloc.symbol][0], reloc.addend, P);
+                        fixups[reloc.symbol].push_back({obj_idx, P, static_cast<int>(RelocationType::R_X86_64_PC32), reloc.addend});
+                    }
+                }
+                else if (local_it != locals.end())
+                {
+                    patch_reloc(image_at(P), reloc.type, local_it->second, reloc.addend, P);
+                }
+                else if (external.contains(reloc.symbol))
+                {
+                    // 外部函数填 PLT 的相对地址，外部数据填 GOT 的相对地址
+                    const auto& slots = external[reloc.symbol];
+                    uint64_t S = reloc.type == RelocationType::R_X86_64_PC32 ? slots[0].get<uint64_t>() : slots[1].get<uint64_t>();
+                    if (S == 0) throw runtime_error("no PLT slot for " + reloc.symbol + " (PC32 reference to imported data, compile with -fPIC)");
+                    patch_reloc(image_at(P), RelocationType::R_X86_64_PC32, S, reloc.addend, P);
+                }
+                else if (symbols.contains(reloc.symbol))
+                {
+                    patch_reloc(image_at(P), reloc.type, symbols[reloc.symbol][0], reloc.addend, P);
+                    fixups[reloc.symbol].push_back({obj_idx, P, static_cast<int>(reloc.type), reloc.addend});
+                }
+                else if (!options.shared)
+                {
+                    return "relocation points to an undefined symbol: " + reloc.symbol;
+                }
+                else continue;
+                ++reapplied;
+            }
+        }
+    }
+
+    // 其余目标文件里引用了挪动过的符号的位置，按重定位索引逐个修补
+    for (const auto& [name, addr] : moved)
+    {
+        if (!fixups.contains(name)) continue;
+        for (const auto& f : fixups[name])
+        {
+            if (changed_set.count(f[0].get<size_t>())) continue;
+            uint64_t P = f[1];
+            patch_reloc(image_at(P), static_cast<RelocationType>(f[2].get<int>()), addr, f[3].get<int64_t>(), P);
+            ++reapplied;
+        }
+    }
+
+    if (!options.shared)
+    {
+        if (!symbols.contains(options.entryPoint)) return "entry point not found";
+        result.entry = symbols[options.entryPoint][0];
+    }
+    sort(result.symbols.begin(), result.symbols.end(),
+        [](const Symbol& a, const Symbol& b) { return a.name < b.name; });
+
+    write_output(result, options.outputFile, options.pool);
+    for (size_t i = 0; i < inputs.size(); ++i) in_files[i]["hash"] = hashes[i];
+    state["output_hash"] = hash_file(options.outputFile);
+    ofstream out(state_path(options));
+    out << state.dump() << endl;
+
+    cerr << "incremental: relinked " << changed_objs.size() << " of " << objects.size()
+         << " objects, re-applied " << reapplied << " relocations" << endl;
+    return "";
+}
+
+void FLE_ld_incremental(const std::vector<std::string>& inputs, const LinkerOptions& options)
+{
+    vector<uint64_t> hashes(inputs.size());
+    parallel_for(options.pool, inputs.size(), [&](size_t i) { hashes[i] = hash_file(inputs[i]); });
+
+    string reason = "no previous link state";
+    string old_state = read_file(state_path(options));
+    if (!old_state.empty())
+    {
+        json state = json::parse(old_state, nullptr, false);
+        if (state.is_discarded() || !state.is_object()) reason = "no usable link state";
+        else reason = try_patch(state, inputs, hashes, options);
+        if (reason.empty()) return;
+    }
+
+    cerr << "incremental: full link (" << reason << ")" << endl;
+    full_link(inputs, hashes, options);
+}
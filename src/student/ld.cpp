@@ -1,25 +1,185 @@
 #include "fle.hpp"
+#include "incremental.hpp"
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <map>
 #include <stdexcept>
 #include <vector>
 #include <stdio.h>
+#include <unordered_map>
 #include <unordered_set>
-#include <queue>
+#include <optional>
+#include <thread>
+#include "reloc_batch.hpp"
+#include "symbol_table.hpp"
+#include "thread_pool.hpp"
+#include "link_stats.hpp"
+#include "time_trace.hpp"
 using namespace std;
 
-FLEObject FLE_ld(const std::vector<FLEObject>& objects, const LinkerOptions& options)
+// 输出节描述：决定输入节归到哪个输出节、输出顺序以及权限
+// 新增一个输出节（比如 .init_array）只需要在表里加一行
+struct OutputSectionSpec
+{
+    string name;
+    vector<string> prefixes; // 名字以这些前缀开头的输入节归入该输出节
+    uint32_t phdr_flags; // 程序头权限
+    uint32_t shdr_flags; // 节头标志
+    bool nobits; // 不占文件空间（SHT_NOBITS），所有 NOBITS 输入节都归到这里
+    uint64_t align; // 段内紧凑排列（--compact-segments）时节起始地址的对齐
+};
+
+// 权限相同的输出节排在一起，紧凑布局时依次归入 RX、R、RW 三个段
+static const vector<OutputSectionSpec> output_specs = {
+    {".text",   {".text"},   PHF::R | PHF::X,                 SHF::ALLOC | SHF::EXEC,             false, 16},
+    {".plt",    {".plt"},    PHF::R | PHF::X,                 SHF::ALLOC | SHF::EXEC,             false, 16},
+    {".rodata", {".rodata"}, static_cast<uint32_t>(PHF::R),   static_cast<uint32_t>(SHF::ALLOC),  false, 16},
+    {".got",    {".got"},    PHF::R | PHF::W,                 SHF::ALLOC | SHF::WRITE,            false, 8},
+    {".data",   {".data"},   PHF::R | PHF::W,                 SHF::ALLOC | SHF::WRITE,            false, 16},
+    {".bss",    {".bss"},    PHF::R | PHF::W,                 SHF::ALLOC | SHF::WRITE,            true,  16},
+};
+
+// 输入节 -> 输出节编号（output_specs 的下标）
+static size_t match_output_section(const SectionHeader& shdr)
+{
+    for (size_t id = 0; id < output_specs.size(); ++id)
+    {
+        const auto& spec = output_specs[id];
+        // bss 没啥用（.bss 节 data 为空，不用合并），NOBITS 节统一归到 NOBITS 输出节
+        if (shdr.type == 8)
+        {
+            if (spec.nobits) return id;
+            continue;
+        }
+        for (const auto& prefix : spec.prefixes)
+        {
+            if (shdr.name.starts_with(prefix)) return id;
+        }
+    }
+    throw std::runtime_error("Unknown section: " + shdr.name);
+}
+
+// 可合并节的种类：字符串节按字符宽度切成以 0 结尾的字符串，常量节按固定大小切成表项
+struct MergeKind
+{
+    uint64_t entsize; // 字符宽度或常量大小，0 表示不可合并
+    bool strings;
+};
+
+// 只合并 cc 带过来、标了 SHF_MERGE 的节：带 SHF_STRINGS 的按 entsize 宽的字符切成字符串，否则切成 entsize 字节的常量。
+// 名字像 .rodata.str1、.rodata.cst8 的普通变量（-fdata-sections）没有这个标志，不能合并。
+// 标了 SHF_MERGE 但带重定位的节（比如指针表）也不能合并，由调用处检查
+static MergeKind merge_kind(const SectionHeader& shdr)
+{
+    if (!(shdr.flags & SHF::MERGE) || shdr.entsize == 0) return {0, false};
+    return {shdr.entsize, shdr.flags & SHF::STRINGS};
+}
+
+// 调用图聚类（C3，Pettis-Hansen 的改进）：节点是输入节，边是节之间的调用权重。
+// 每个节点先自成一簇；按密度（被调用权重 / 大小）从高到低处理，把簇接到它最主要的调用者所在簇的后面，
+// 这样热的调用者和被调用者挨在一起。合并后超过 max_cluster_size、或者会把调用者的簇密度稀释太多时不合并。
+// 最后各簇按密度从高到低排列，返回节点的摆放顺序
+static vector<size_t> call_graph_order(const vector<uint64_t>& sizes, const map<pair<size_t, size_t>, uint64_t>& edges,
+                                       uint64_t max_cluster_size)
+{
+    const size_t NONE = SIZE_MAX;
+    const double MAX_DENSITY_DEGRADATION = 8.0;
+    struct Cluster
+    {
+        uint64_t size;
+        uint64_t weight; // 簇内各节被调用的总权重
+        uint64_t initial_weight; // 合并前这个节自己被调用的权重
+        size_t best_pred = NONE; // 调用这个节最多的节
+        uint64_t best_weight = 0;
+        vector<size_t> members;
+        double density() const { return size == 0 ? 0.0 : static_cast<double>(weight) / size; }
+    };
+    vector<Cluster> clusters;
+    for (size_t i = 0; i < sizes.size(); ++i) clusters.push_back({sizes[i], 0, 0, NONE, 0, {i}});
+    for (const auto& [edge, weight] : edges)
+    {
+        auto [from, to] = edge;
+        if (from == to) continue;
+        clusters[to].weight += weight;
+        if (clusters[to].best_pred == NONE || weight > clusters[to].best_weight)
+        {
+            clusters[to].best_pred = from;
+            clusters[to].best_weight = weight;
+        }
+    }
+    for (auto& c : clusters) c.initial_weight = c.weight;
+
+    vector<size_t> sorted(clusters.size());
+    for (size_t i = 0; i < sorted.size(); ++i) sorted[i] = i;
+    stable_sort(sorted.begin(), sorted.end(), [&](size_t a, size_t b) { return clusters[a].density() > clusters[b].density(); });
+
+    vector<size_t> leader(clusters.size()); // 节点所在簇的代表
+    for (size_t i = 0; i < leader.size(); ++i) leader[i] = i;
+    auto find_leader = [&](size_t i)
+    {
+        while (leader[i] != i) i = leader[i] = leader[leader[i]];
+        return i;
+    };
+    for (size_t i : sorted)
+    {
+        Cluster& c = clusters[i];
+        // 最主要的调用者只占很小一部分时，挂在它后面意义不大
+        if (c.best_pred == NONE || c.best_weight * 10 <= c.initial_weight) continue;
+        size_t pred = find_leader(c.best_pred);
+        if (pred == i) continue;
+        Cluster& p = clusters[pred];
+        if (c.size + p.size > max_cluster_size) continue;
+        double merged_density = static_cast<double>(p.weight + c.weight) / static_cast<double>(p.size + c.size);
+        if (merged_density < p.density() / MAX_DENSITY_DEGRADATION) continue;
+        leader[i] = pred;
+        p.members.insert(p.members.end(), c.members.begin(), c.members.end());
+        p.size += c.size;
+        p.weight += c.weight;
+        c.members.clear();
+    }
+
+    vector<size_t> leaders;
+    for (size_t i = 0; i < clusters.size(); ++i)
+    {
+        if (find_leader(i) == i) leaders.push_back(i);
+    }
+    stable_sort(leaders.begin(), leaders.end(), [&](size_t a, size_t b) { return clusters[a].density() > clusters[b].density(); });
+    vector<size_t> order;
+    for (size_t i : leaders) order.insert(order.end(), clusters[i].members.begin(), clusters[i].members.end());
+    return order;
+}
+
+FLEObject FLE_ld(const std::vector<FLEObject>& objects, const LinkerOptions& options, LinkLayout* layout)
+{
+    vector<const FLEObject*> inputs;
+    for (const auto& obj : objects) inputs.push_back(&obj);
+    return FLE_ld(inputs, options, layout);
+}
+
+FLEObject FLE_ld(const std::vector<const FLEObject*>& objects, const LinkerOptions& options, LinkLayout* layout)
 {
 
     // TODO: 实现链接器
     FLEObject result;
-    vector<FLEObject> curr_objs;
-    vector<FLEObject> curr_ars;
-    unordered_set <string> obj_names;
-    queue <FLEObject> to_process;
+    // 各阶段共用一个线程池：驱动程序建好的就直接用，否则按 --threads 自己建一个
+    optional<ThreadPool> own_pool;
+    ThreadPool* pool = options.pool;
+    if (!pool) pool = &own_pool.emplace(options.threads ? options.threads : thread::hardware_concurrency());
+    TimeTrace* trace = options.trace; // --time-trace，为空时各阶段不计时
+    LinkStats* stats = options.stats; // --stats，为空时不统计
+    // 只保存指向调用者 objects（及其中静态库成员）的指针，不复制节数据
+    vector<const FLEObject*> curr_objs;
+    vector<pair<size_t,size_t>> curr_origins; // 每个选中目标文件的来源：(第几个输入, 静态库成员下标)
+    vector<const FLEObject*> curr_ars;
+    vector<size_t> ar_inputs; // 每个静态库是第几个输入
     unordered_map <string,string> so_symbol_section;
     unordered_map <string,int> so_symbol_offset;
+    vector <string> so_references; // 共享库引用、需要由本次链接提供的符号
 
     result.name = options.outputFile;  // 程序名在options里
     if(options.shared == true)
@@ -33,79 +193,141 @@ FLEObject FLE_ld(const std::vector<FLEObject>& objects, const LinkerOptions& opt
     uint64_t base_vaddr = 0x400000; // 基础地址
     size_t page_size = 0x1000; // x86_64 页面大小对齐
 
+    unordered_set <string> defined_syms; // 已选中目标文件定义的全局符号
+    vector <string> pending; // 未解析的未定义符号，按出现顺序；扫描静态库时就是工作表
+    unordered_set <string> pending_set; // pending 里已有的名字
+
+    // 选中一个目标文件：定义的符号记为已定义，新出现的未定义符号加入工作表
+    auto add_object = [&](const FLEObject& obj, size_t input, size_t member)
+    {
+        curr_objs.push_back(&obj);
+        curr_origins.emplace_back(input, member);
+        for (const auto& sym : obj.symbols)
+        {
+            if (sym.type != SymbolType::UNDEFINED && sym.type != SymbolType::LOCAL) defined_syms.insert(sym.name);
+        }
+        for (const auto& sym : obj.symbols)
+        {
+            if (sym.type == SymbolType::UNDEFINED && !defined_syms.count(sym.name) && pending_set.insert(sym.name).second) pending.push_back(sym.name);
+        }
+    };
+
+    TraceSpan resolve_span(trace, "archive resolution");
     // 区分静态库与目标文件与共享库
     for(size_t obj_idx = 0; obj_idx < objects.size(); ++obj_idx)
     {
-        const auto& obj = objects[obj_idx];
-        if(obj.type == ".ar") curr_ars.push_back(obj);
-        else if(obj.type == ".obj") 
+        const auto& obj = *objects[obj_idx];
+        if(obj.type == ".ar")
         {
-            curr_objs.push_back(obj);
-            obj_names.insert(obj.name);
-            to_process.push(obj);
+            curr_ars.push_back(&obj);
+            ar_inputs.push_back(obj_idx);
         }
+        else if(obj.type == ".obj") add_object(obj, obj_idx, LinkLayout::NO_MEMBER);
         else  // 共享库：直接记录为依赖（无需链接，运行时加载）
         {
             
             result.needed.push_back(obj.name);            
             for(const auto& sym : obj.symbols)
             {
-                if(sym.type == SymbolType::UNDEFINED) continue;     // 未定义符号说明这个符号的定义不来自这个文件
+                if(sym.type == SymbolType::UNDEFINED)     // 未定义符号说明这个符号的定义不来自这个文件
+                {
+                    so_references.push_back(sym.name);
+                    continue;
+                }
                 so_symbol_section[sym.name] = sym.section;
                 so_symbol_offset[sym.name] = sym.offset;
             }
         }
     }
 
-    // 按需链接
-    while(!to_process.empty())
-    {       
-        const auto& obj = to_process.front();
-        to_process.pop();
-        unordered_set <string> Undef_syms;
-        unordered_set <string> Def_syms;
-        // 遍历符号表，看有没有符号来自没被加入的目标文件的
-        // （准确来说是还没被加到obj_names的）
-        // 有的话就去静态库表里找
-        for (const auto& sym : obj.symbols) 
+    // 各静态库的导出符号并行收集（同一成员里的按符号顺序）
+    vector<vector<pair<const string*, size_t>>> ar_exports(curr_ars.size()); // (符号名, 成员下标)
+    parallel_for(pool, curr_ars.size(), [&](size_t ar_idx)
+    {
+        const auto& ar = *curr_ars[ar_idx];
+        for(size_t mem_idx = 0; mem_idx < ar.members.size(); ++mem_idx)
         {
-            // 跳过已定义符号
-            if (sym.type != SymbolType::UNDEFINED) continue;
-            else 
+            for(const auto& sym : ar.members[mem_idx].symbols)
             {
-                Undef_syms.insert(sym.name);
+                if(sym.type == SymbolType::UNDEFINED || sym.type == SymbolType::LOCAL) continue;
+                ar_exports[ar_idx].emplace_back(&sym.name, mem_idx);
             }
         }
-        for (const auto& sym : obj.symbols) 
+    });
+
+    // 目标文件总是全部链接进来。默认所有静态库是一组：任何一个静态库都能解析任何未定义符号，
+    // 后面的静态库引用前面的也可以，同名符号取命令行上最先出现的定义。
+    // --strict-archive-order 时静态库按命令行顺序扫描，只能解析扫描到它时还未解析的符号
+    // （包括它自己被拉入的成员带来的）；--start-group/--end-group 之间的静态库作为一组一起扫描，
+    // 组内互相依赖的静态库也能解析，不在组里的静态库自成一组
+    vector<vector<size_t>> ar_groups; // 每组静态库的下标（curr_ars 中）
+    size_t prev_group = SIZE_MAX;
+    for(size_t ar_idx = 0; ar_idx < curr_ars.size(); ++ar_idx)
+    {
+        if(!options.strict_archive_order)
         {
-            if (sym.type == SymbolType::UNDEFINED) continue; // 跳过未定义符号
-            Def_syms.insert(sym.name); // 收集当前obj的已定义符号
+            if(ar_groups.empty()) ar_groups.emplace_back();
+            ar_groups.back().push_back(ar_idx);
+            continue;
         }
-        // 遍历静态库
-        for(const auto& ar : curr_ars)
+        size_t group = SIZE_MAX;
+        for(size_t g = 0; g < options.archive_groups.size(); ++g)
         {
-            for(const auto& member : ar.members)
-            {
-                if(obj_names.count(member.name)) continue;
-                for(const auto& sym : member.symbols)
-                {
-                    // 找到了有符号依赖而且从来没被更新过的目标文件
-                    if(Undef_syms.count(sym.name) && (!Def_syms.count(sym.name)))
-                    {
-                        curr_objs.push_back(member);
-                        obj_names.insert(member.name);
-                        Def_syms.insert(sym.name);
-                        to_process.push(member);
-                    }
-                }
-            }
+            auto [first, last] = options.archive_groups[g];
+            if(first <= ar_inputs[ar_idx] && ar_inputs[ar_idx] < last) group = g;
+        }
+        if(group == SIZE_MAX || group != prev_group) ar_groups.emplace_back();
+        ar_groups.back().push_back(ar_idx);
+        prev_group = group;
+    }
+
+    for(const auto& ar_group : ar_groups)
+    {
+        // 组内的符号索引：符号名 -> (静态库下标, 成员下标)
+        // 同一符号被多个成员定义时，只记录命令行顺序中最先出现的那个
+        unordered_map <string, pair<size_t,size_t>> ar_index;
+        for(size_t ar_idx : ar_group)
+        {
+            for(const auto& [name, mem_idx] : ar_exports[ar_idx]) ar_index.try_emplace(*name, ar_idx, mem_idx);
+        }
+
+        // 去掉之前的组已经解析掉的符号
+        erase_if(pending, [&](const string& name)
+        {
+            if(!defined_syms.count(name)) return false;
+            pending_set.erase(name);
+            return true;
+        });
+
+        // 工作表：先是此刻所有未解析的符号，之后只有新拉入的成员带来的未定义符号，
+        // 所以一个组只会因为新的需求被再次查找，循环依赖（互相引用的成员）自然收敛
+        for(size_t i = 0; i < pending.size(); ++i)
+        {
+            // 已经有定义了（成员被拉入后它定义的所有符号都会记为已定义）
+            if(defined_syms.count(pending[i])) continue;
+            auto it = ar_index.find(pending[i]);
+            // 组里没有，留给后面的组、共享库或者后面报未定义错误
+            if(it == ar_index.end()) continue;
+            auto [ar_idx, mem_idx] = it->second;
+            add_object(curr_ars[ar_idx]->members[mem_idx], ar_inputs[ar_idx], mem_idx);
         }
     }
    
-    map<string, FLESection> merged_sec; // 合并后的节
-    map<string, vector<uint8_t>> merged_sec_data;
+    if (trace || stats)
+    {
+        size_t members = count_if(curr_origins.begin(), curr_origins.end(), [](const auto& origin) { return origin.second != LinkLayout::NO_MEMBER; });
+        resolve_span.arg("objects", curr_objs.size() - members);
+        resolve_span.arg("archives", curr_ars.size());
+        resolve_span.arg("members pulled", members);
+        if (stats)
+        {
+            stats->objects = curr_objs.size();
+            stats->members_pulled = members;
+        }
+    }
+    resolve_span.end();
+
     int64_t current_vaddr = base_vaddr; // 当前合并节更新到的地址
-    vector<string> section_order = {".text",".plt",".rodata",".got",".data",".bss"};
 
     struct SecInfo 
     {
@@ -113,140 +335,850 @@ FLEObject FLE_ld(const std::vector<FLEObject>& objects, const LinkerOptions& opt
         size_t size;
     };
 
-    map<string, SecInfo> global_sections; // 全局的大合并节的初始位置和大小
-    map<pair<size_t,string>, size_t> pre_sec_addr; // 原来的小节在原文件的起始地址
+    // 输出节按编号（output_specs 的下标）存放
+    vector<FLESection> merged_sec(output_specs.size()); // 合并后的节
+    vector<SecInfo> global_sections(output_specs.size(), SecInfo{0, 0}); // 全局的大合并节的初始位置和大小
+    unordered_map<string, size_t> out_sec_id; // 输出节名 -> 编号
+    for (size_t id = 0; id < output_specs.size(); ++id) out_sec_id[output_specs[id].name] = id;
+    const size_t GOT = out_sec_id.at(".got");
+    const size_t PLT = out_sec_id.at(".plt");
+
+    // 每个输入节一条映射记录，按 [目标文件下标][节头下标] 存放，之后的遍历直接下标访问
+    struct InputSectionMap
+    {
+        size_t out_id; // 输出节编号
+        uint64_t out_offset; // 在输出节中的偏移
+        uint64_t addr; // 运行时地址（分配地址后填写）
+        uint64_t capacity; // 占据的槽位大小（增量链接时比实际大小多出预留空间）
+    };
+    vector<vector<InputSectionMap>> sec_maps(curr_objs.size());
+    vector<unordered_map<string, size_t>> sec_index(curr_objs.size()); // 节名 -> 节头下标
+
+    // 增量链接时每个输入节后面留一段空白，下次这个文件变大一点也能原地放下
+    auto slot_padding = [&](size_t out_id) -> uint64_t
+    {
+        if (!options.incremental) return 0;
+        auto it = options.incremental_padding.find(output_specs[out_id].name);
+        return it == options.incremental_padding.end() ? options.incremental_default_padding : it->second;
+    };
+
+    // 构建全局符号表 + 处理符号冲突（只依赖符号所在的输入节，不依赖布局）
+    // 符号名先驻留成编号，符号表以编号为键。全局符号放在一张表里，
+    // 局部符号按目标文件各放一张表，不会和其他文件冲突，也不用再拼 "文件名::符号名"
+    struct SymbolDef
+    {
+        SymbolType type;
+        size_t obj_idx; // 定义所在的目标文件
+        size_t shdr_idx; // 所在输入节（节头下标）
+        const Symbol* sym; // 原始符号（取节内偏移、名字和大小）
+    };
+    ShardedStringInterner names;
+    ShardedIdHashMap<SymbolDef> global_symbols; // 全局符号表（GLOBAL / WEAK），按名字哈希分片
+    vector<IdHashMap<SymbolDef>> local_symbols(curr_objs.size()); // 各目标文件的局部符号
+    unordered_set<string> external_symbols; // 所有外部符号（需动态解析）
+
+    TraceSpan symtab_span(trace, "symbol table");
+    // 第一步，按目标文件并行：建节名索引，找出每个已定义符号所在的输入节，
+    // 算好符号名的哈希，再把符号下标按分片号做计数排序
+    const size_t NO_SECTION = SIZE_MAX;
+    vector<vector<uint64_t>> name_hashes(curr_objs.size());
+    vector<vector<size_t>> sym_shdr(curr_objs.size()); // 符号所在的节头下标
+    vector<vector<uint32_t>> sym_ids(curr_objs.size()); // 符号名编号
+    vector<vector<uint32_t>> shard_order(curr_objs.size()); // 符号下标，按分片号排序，同一分片内保持原顺序
+    vector<array<uint32_t, SYMBOL_SHARDS + 1>> shard_begin(curr_objs.size()); // 每个分片在 shard_order 中的起点
+    vector<size_t> bad_symbol(curr_objs.size(), SIZE_MAX); // 第一个所在节不存在的符号
+    parallel_for(pool, curr_objs.size(), [&](size_t obj_idx)
+    {
+        const auto& obj = *curr_objs[obj_idx];
+        size_t n = obj.symbols.size();
+        for (size_t shdr_idx = 0; shdr_idx < obj.shdrs.size(); ++shdr_idx) sec_index[obj_idx][obj.shdrs[shdr_idx].name] = shdr_idx;
+        name_hashes[obj_idx].resize(n);
+        sym_shdr[obj_idx].assign(n, NO_SECTION);
+        sym_ids[obj_idx].resize(n);
+        auto& begin = shard_begin[obj_idx];
+        begin.fill(0);
+        for (size_t sym_idx = 0; sym_idx < n; ++sym_idx)
+        {
+            const auto& sym = obj.symbols[sym_idx];
+            name_hashes[obj_idx][sym_idx] = hash_name(sym.name);
+            ++begin[shard_of(name_hashes[obj_idx][sym_idx]) + 1];
+            if (sym.type == SymbolType::UNDEFINED) continue;
+            auto idx_it = sec_index[obj_idx].find(sym.section);
+            if (idx_it != sec_index[obj_idx].end()) sym_shdr[obj_idx][sym_idx] = idx_it->second;
+            else if (bad_symbol[obj_idx] == SIZE_MAX) bad_symbol[obj_idx] = sym_idx;
+        }
+        for (size_t shard = 0; shard < SYMBOL_SHARDS; ++shard) begin[shard + 1] += begin[shard];
+        auto next = begin;
+        shard_order[obj_idx].resize(n);
+        for (size_t sym_idx = 0; sym_idx < n; ++sym_idx) shard_order[obj_idx][next[shard_of(name_hashes[obj_idx][sym_idx])]++] = sym_idx;
+    });
+
+    // 第二步，按分片并行：每个分片由一个线程按输入顺序驻留名字并决议全局符号，
+    // 冲突规则和串行时一样（GLOBAL > WEAK，同名的局部符号互不影响），结果与线程数无关
+    // 出错时分片只记下第一处位置，最后取输入顺序中最早的那个报错，与串行链接报的一致
+    vector<pair<size_t, size_t>> first_conflict(SYMBOL_SHARDS, {SIZE_MAX, SIZE_MAX}); // (目标文件, 符号下标)
+    vector<vector<const string*>> shard_externals(SYMBOL_SHARDS);
+    parallel_for(pool, SYMBOL_SHARDS, [&](size_t shard)
+    {
+        auto& table = global_symbols.shard(shard);
+        for (size_t obj_idx = 0; obj_idx < curr_objs.size(); ++obj_idx) 
+        {
+            const auto& obj = *curr_objs[obj_idx];
+            for (uint32_t k = shard_begin[obj_idx][shard]; k < shard_begin[obj_idx][shard + 1]; ++k) 
+            {
+                uint32_t sym_idx = shard_order[obj_idx][k];
+                const auto& sym = obj.symbols[sym_idx];
+                uint32_t name_id = names.intern(sym.name, name_hashes[obj_idx][sym_idx]);
+                sym_ids[obj_idx][sym_idx] = name_id;
+                // 将未定义符号名称加入到外部符号集合，然后跳过；
+                // 未定义符号的section,offset和size都为0
+                // 不过这里的未定义符号还不能保证一定是外部符号
+                // 但是他在.so库里面就是正常的符号
+                // 共享库才考虑外部符号
+                if (sym.type == SymbolType::UNDEFINED) 
+                {
+                    shard_externals[shard].push_back(&sym.name);
+                    continue;
+                }
+                else if(sym.type == SymbolType::WEAK && sym.section != ".text") // 弱变量符号
+                {
+                    shard_externals[shard].push_back(&sym.name);
+                }
+
+                // 局部符号只在本文件内可见，第三步再按文件放进各自的表；所在节不存在的符号已经记下了
+                if (sym.type == SymbolType::LOCAL || sym_shdr[obj_idx][sym_idx] == NO_SECTION) continue;
+
+                // 处理符号冲突：强符号覆盖弱符号
+                auto [slot, inserted] = table.try_emplace(name_id);
+                if (!inserted) 
+                {
+                    // 冲突规则：GLOBAL > WEAK
+                    if (sym.type == SymbolType::GLOBAL && slot->type == SymbolType::GLOBAL) 
+                    {
+                        // 同时存在两个相同的全局变量，记下位置，这个分片不再往下处理
+                        first_conflict[shard] = {obj_idx, sym_idx};
+                        return;
+                    }
+                    // 当前的符号无法替换表内的符号（弱符号遇到已有定义），那么就跳过。
+                    if (sym.type != SymbolType::GLOBAL) continue;
+                }
+                // 记下符号所在的输入节，地址等布局确定后再算
+                *slot = SymbolDef{sym.type, obj_idx, sym_shdr[obj_idx][sym_idx], &sym};
+            }
+        }
+    });
 
-    // 初始化global_sections
-    for (const auto& head: section_order)
+    pair<size_t, size_t> first_error{SIZE_MAX, SIZE_MAX};
+    for (size_t obj_idx = 0; obj_idx < curr_objs.size(); ++obj_idx)
+    {
+        if (bad_symbol[obj_idx] != SIZE_MAX) first_error = min(first_error, {obj_idx, bad_symbol[obj_idx]});
+    }
+    for (const auto& conflict : first_conflict) first_error = min(first_error, conflict);
+    if (first_error.first != SIZE_MAX)
+    {
+        const auto& sym = curr_objs[first_error.first]->symbols[first_error.second];
+        if (sym_shdr[first_error.first][first_error.second] == NO_SECTION)
+        {
+            throw runtime_error("Symbol " + sym.name + " is in unknown section: " + sym.section);
+        }
+        throw runtime_error("Multiple definition of strong symbol: " + sym.name);
+    }
+    for (const auto& externals : shard_externals)
     {
-        global_sections[head] = SecInfo{0, 0};
+        for (const string* name : externals) external_symbols.insert(*name);
     }
 
-    // 第一次遍历：合并节 + 分配内存地址
-    // 先合并节
+    // 第三步，按目标文件并行：局部符号只在本文件内可见，同名的保留第一个
+    parallel_for(pool, curr_objs.size(), [&](size_t obj_idx)
+    {
+        const auto& obj = *curr_objs[obj_idx];
+        for (size_t sym_idx = 0; sym_idx < obj.symbols.size(); ++sym_idx)
+        {
+            const auto& sym = obj.symbols[sym_idx];
+            if (sym.type != SymbolType::LOCAL) continue;
+            auto [slot, inserted] = local_symbols[obj_idx].try_emplace(sym_ids[obj_idx][sym_idx]);
+            if (inserted) *slot = SymbolDef{sym.type, obj_idx, sym_shdr[obj_idx][sym_idx], &sym};
+        }
+    });
+
+    if (trace || stats)
+    {
+        size_t symbols = 0;
+        for (const auto* obj : curr_objs) symbols += obj->symbols.size();
+        if (stats)
+        {
+            for (const auto* obj : curr_objs)
+                for (const auto& sym : obj->symbols) ++stats->symbols[static_cast<size_t>(sym.type)];
+        }
+        symtab_span.arg("symbols", symbols);
+        symtab_span.arg("globals", global_symbols.size());
+    }
+    symtab_span.end();
+
+    // 全局符号表里是否有这个名字的定义
+    auto find_global = [&](const string& name) -> const SymbolDef*
+    {
+        uint32_t name_id = names.find(name);
+        return name_id == ShardedStringInterner::NONE ? nullptr : global_symbols.find(name_id);
+    };
+
+    // 重定位引用的定义：与重定位时一样，先找本文件的局部符号，再找全局符号
+    auto find_target = [&](size_t obj_idx, const string& name) -> const SymbolDef*
+    {
+        uint32_t name_id = names.find(name);
+        if (name_id == ShardedStringInterner::NONE) return nullptr;
+        const SymbolDef* def = local_symbols[obj_idx].find(name_id);
+        return def ? def : global_symbols.find(name_id);
+    };
+
+    TraceSpan gc_span(trace, "gc sections");
+    // 节垃圾回收（--gc-sections）：输入节为点、重定位为边，
+    // 从入口、导出符号和共享库引用的符号出发标记能到达的节，其余的不参与布局
+    vector<vector<char>> live(curr_objs.size());
     for (size_t obj_idx = 0; obj_idx < curr_objs.size(); ++obj_idx)
     {
-        const auto& obj = curr_objs[obj_idx];
-        // 先遍历节头，记录各小节的大小
-        for (const auto& shdr : obj.shdrs) 
+        live[obj_idx].assign(curr_objs[obj_idx]->shdrs.size(), !options.gc_sections);
+    }
+    if (options.gc_sections)
+    {
+        vector<pair<size_t, size_t>> worklist;
+        auto mark = [&](const SymbolDef* def)
         {
-            // bss 没啥用（.bss 节 data 为空，不用合并）
-            if (shdr.type == 8) 
+            if (!def || live[def->obj_idx][def->shdr_idx]) return;
+            live[def->obj_idx][def->shdr_idx] = 1;
+            worklist.emplace_back(def->obj_idx, def->shdr_idx);
+        };
+
+        if (!options.shared) mark(find_global(options.entryPoint));
+        else global_symbols.for_each([&](uint32_t, const SymbolDef& def) { mark(&def); }); // 共享库导出所有全局符号
+        for (const auto& name : so_references) mark(find_global(name));
+
+        while (!worklist.empty())
+        {
+            auto [obj_idx, shdr_idx] = worklist.back();
+            worklist.pop_back();
+            const auto& obj = *curr_objs[obj_idx];
+            const auto& shdr = obj.shdrs[shdr_idx];
+            if (shdr.type == 8) continue;
+            for (const auto& reloc : obj.sections.at(shdr.name).relocs) mark(find_target(obj_idx, reloc.symbol));
+        }
+
+        for (size_t obj_idx = 0; obj_idx < curr_objs.size(); ++obj_idx)
+        {
+            const auto& obj = *curr_objs[obj_idx];
+            for (size_t shdr_idx = 0; shdr_idx < obj.shdrs.size(); ++shdr_idx)
             {
-                pre_sec_addr[{obj_idx, shdr.name}] = global_sections[".bss"].size;
-                global_sections[".bss"].size += shdr.size;
-                continue;
+                if (live[obj_idx][shdr_idx] || !options.print_gc_sections) continue;
+                cerr << "removing unused section '" << obj.shdrs[shdr_idx].name << "' in file '" << obj.name << "'" << endl;
+            }
+        }
+    }
+
+    if (trace)
+    {
+        size_t sections = 0, live_sections = 0;
+        for (const auto& flags : live)
+        {
+            sections += flags.size();
+            live_sections += count(flags.begin(), flags.end(), 1);
+        }
+        gc_span.arg("sections", sections);
+        gc_span.arg("live", live_sections);
+    }
+    gc_span.end();
+
+    TraceSpan merge_span(trace, "merge strings and constants");
+    // 合并标了 SHF_MERGE 的字符串节（.rodata.str*）和常量节（.rodata.cst*）：把每个节切成表项（以 0 结尾的字符串或定长常量），
+    // 所有输入里相同的表项只保留一份，同一输出节、同一种类和大小的表项拼成一个合并块。
+    // 常量按大小对齐，合并块从对齐的位置开始、表项大小不变，去重后每个常量仍然是对齐的。
+    // -O2 时一个字符串是另一个的后缀也共用存储。增量链接要求每个输入节有自己的槽位，不做合并
+    struct MergePiece
+    {
+        uint64_t in_offset; // 在输入节中的偏移
+        uint64_t out_offset; // 在合并块中的偏移
+    };
+    struct MergeBlock
+    {
+        size_t out_id; // 输出节编号
+        uint64_t entsize; // 字符宽度或常量大小
+        bool strings; // 字符串块（可以尾部合并）
+        uint64_t align; // 合并块的对齐：entsize 和输入节 sh_addralign 中大的那个
+        vector<uint8_t> data; // 去重后的内容
+        uint64_t out_offset; // 在输出节中的偏移（布局时填写）
+    };
+    struct MergeInfo
+    {
+        int64_t block = -1; // 所属合并块，-1 表示不是可合并节
+        vector<MergePiece> pieces; // 按 in_offset 递增
+    };
+    vector<MergeBlock> merge_blocks;
+    vector<vector<MergeInfo>> merge_info(curr_objs.size());
+    for (size_t obj_idx = 0; obj_idx < curr_objs.size(); ++obj_idx) merge_info[obj_idx].resize(curr_objs[obj_idx]->shdrs.size());
+    auto is_merged = [&](size_t obj_idx, size_t shdr_idx) { return merge_info[obj_idx][shdr_idx].block >= 0; };
+    if (options.optimize >= 1 && !options.incremental)
+    {
+        struct MergeInput
+        {
+            size_t obj_idx;
+            size_t shdr_idx;
+            MergeKind kind;
+        };
+        vector<MergeInput> inputs;
+        for (size_t obj_idx = 0; obj_idx < curr_objs.size(); ++obj_idx)
+        {
+            const auto& obj = *curr_objs[obj_idx];
+            for (size_t shdr_idx = 0; shdr_idx < obj.shdrs.size(); ++shdr_idx)
+            {
+                const auto& shdr = obj.shdrs[shdr_idx];
+                MergeKind kind = merge_kind(shdr);
+                if (kind.entsize == 0 || shdr.type == 8 || !live[obj_idx][shdr_idx]) continue;
+                // 带重定位的节按原始字节去重会把指向不同目标的表项折叠成一个，合并块也没有地方落这些重定位，按普通节处理
+                if (!obj.sections.at(shdr.name).relocs.empty()) continue;
+                inputs.push_back({obj_idx, shdr_idx, kind});
             }
+        }
 
-            std::string sec_name = shdr.name;
-            const auto& sec = obj.sections.at(sec_name);
-            bool matched = false;
-            for (const auto& head: section_order)
+        // 各节并行地切成表项；大小不是表项大小的整数倍、或者最后一个字符串没有结尾的 0 时整个节按普通节处理
+        vector<vector<uint64_t>> starts(inputs.size());
+        parallel_for(pool, inputs.size(), [&](size_t i)
+        {
+            const auto& [obj_idx, shdr_idx, kind] = inputs[i];
+            const auto& obj = *curr_objs[obj_idx];
+            const auto& data = obj.sections.at(obj.shdrs[shdr_idx].name).data;
+            uint64_t entsize = kind.entsize;
+            if (data.size() % entsize != 0) return;
+            if (!kind.strings)
+            {
+                for (uint64_t pos = 0; pos < data.size(); pos += entsize) starts[i].push_back(pos);
+                return;
+            }
+            uint64_t begin = 0;
+            for (uint64_t pos = 0; pos < data.size(); pos += entsize)
             {
-                // 找到对应的节
-                if (sec_name.starts_with(head))
+                if (any_of(data.begin() + pos, data.begin() + pos + entsize, [](uint8_t b) { return b != 0; })) continue;
+                starts[i].push_back(begin);
+                begin = pos + entsize;
+            }
+            if (begin != data.size()) starts[i].clear();
+        });
+
+        // 按链接顺序去重，合并块里的表项顺序与输入顺序一致，结果与线程数无关
+        map<tuple<size_t, bool, uint64_t, uint64_t>, size_t> block_of; // (输出节, 是否字符串, 表项大小, 对齐) -> 合并块
+        vector<unordered_map<string_view, uint64_t>> seen; // 每个合并块：表项内容 -> 在合并块中的偏移
+        vector<vector<string_view>> entries; // 每个合并块：按首次出现顺序的表项
+        for (size_t i = 0; i < inputs.size(); ++i)
+        {
+            const auto& [obj_idx, shdr_idx, kind] = inputs[i];
+            if (starts[i].empty()) continue;
+            const auto& obj = *curr_objs[obj_idx];
+            const auto& data = obj.sections.at(obj.shdrs[shdr_idx].name).data;
+            size_t out_id = match_output_section(obj.shdrs[shdr_idx]);
+            // 对齐不同的输入节分开合并，免得 .rodata.str1.1 里的字符串也按 8 字节对齐
+            uint64_t align = max(kind.entsize, obj.shdrs[shdr_idx].addralign);
+            auto [it, inserted] = block_of.try_emplace({out_id, kind.strings, kind.entsize, align}, merge_blocks.size());
+            if (inserted)
+            {
+                merge_blocks.push_back({out_id, kind.entsize, kind.strings, align, {}, 0});
+                seen.emplace_back();
+                entries.emplace_back();
+            }
+            size_t block = it->second;
+            auto& info = merge_info[obj_idx][shdr_idx];
+            info.block = block;
+            for (size_t k = 0; k < starts[i].size(); ++k)
+            {
+                uint64_t begin = starts[i][k];
+                uint64_t end = k + 1 < starts[i].size() ? starts[i][k + 1] : data.size();
+                string_view entry(reinterpret_cast<const char*>(data.data()) + begin, end - begin);
+                auto [pos, added] = seen[block].try_emplace(entry, 0);
+                if (added) entries[block].push_back(entry);
+                info.pieces.push_back({begin, 0});
+            }
+        }
+
+        // 给去重后的表项分配位置。字符串的尾部合并：按反转后的内容从大到小排序，
+        // 这样以某个字符串结尾的更长的字符串恰好排在它前面，它就放在那个字符串的末尾。
+        // 输入节的对齐比表项大小还大时（如 .rodata.str1.8），每个表项都按它对齐，也就不做尾部合并
+        for (size_t block = 0; block < merge_blocks.size(); ++block)
+        {
+            auto& out = merge_blocks[block].data;
+            auto& order = entries[block];
+            uint64_t entsize = merge_blocks[block].entsize;
+            uint64_t entry_align = merge_blocks[block].align > entsize ? merge_blocks[block].align : 1;
+            bool tail_merge = options.optimize >= 2 && merge_blocks[block].strings && entry_align == 1;
+            if (tail_merge)
+            {
+                sort(order.begin(), order.end(), [](string_view a, string_view b)
+                {
+                    return lexicographical_compare(b.rbegin(), b.rend(), a.rbegin(), a.rend());
+                });
+            }
+            string_view prev;
+            uint64_t prev_offset = 0;
+            for (string_view str : order)
+            {
+                if (tail_merge && prev.ends_with(str) && (prev.size() - str.size()) % entsize == 0)
                 {
-                    // 合并内存
-                    merged_sec[head].data.insert
-                    (
-                        merged_sec[head].data.end(),
-                        sec.data.begin(),
-                        sec.data.end()
-                    );
-                    // 重定位不用补0了，原本的输入已经补好了。
-                    // 存下当前小节在合并大节后的初始位置
-                    pre_sec_addr[{obj_idx, sec_name}] = global_sections[head].size;
-                    // 相应的，更新到下一个小节的初始位置
-                    global_sections[head].size += shdr.size;
-                    matched = true;
-                    // 就不能合并重定位标，不然program还以为那个地方是重定位的
-                    merged_sec[head].has_symbols |= sec.has_symbols;
-                    break;
+                    seen[block][str] = prev_offset + prev.size() - str.size();
+                    continue;
                 }
+                out.resize((out.size() + entry_align - 1) / entry_align * entry_align, 0);
+                seen[block][str] = out.size();
+                prev = str;
+                prev_offset = out.size();
+                out.insert(out.end(), str.begin(), str.end());
             }
-            if (!matched) 
+        }
+
+        for (size_t i = 0; i < inputs.size(); ++i)
+        {
+            const auto& [obj_idx, shdr_idx, kind] = inputs[i];
+            auto& info = merge_info[obj_idx][shdr_idx];
+            if (info.block < 0) continue;
+            const auto& obj = *curr_objs[obj_idx];
+            const auto& data = obj.sections.at(obj.shdrs[shdr_idx].name).data;
+            for (size_t k = 0; k < info.pieces.size(); ++k)
             {
-                throw std::runtime_error("Unknown section: " + sec_name);
+                uint64_t begin = info.pieces[k].in_offset;
+                uint64_t end = k + 1 < info.pieces.size() ? info.pieces[k + 1].in_offset : data.size();
+                info.pieces[k].out_offset = seen[info.block].at(string_view(reinterpret_cast<const char*>(data.data()) + begin, end - begin));
             }
         }
     }
 
-    // 第二次遍历：构建全局符号表 + 处理符号冲突
-    map<string, Symbol> global_symbols; // 全局符号表
-    unordered_set<string> external_symbols; // 所有外部符号（需动态解析）
+    // 可合并节里的位置 -> 在合并块中的偏移
+    auto merged_offset = [&](size_t obj_idx, size_t shdr_idx, uint64_t offset) -> uint64_t
+    {
+        const auto& pieces = merge_info[obj_idx][shdr_idx].pieces;
+        auto it = upper_bound(pieces.begin(), pieces.end(), offset,
+            [](uint64_t off, const MergePiece& piece) { return off < piece.in_offset; });
+        if (it != pieces.begin()) --it;
+        return it->out_offset + (offset - it->in_offset);
+    };
+    // 重定位在可合并节里指向的位置：引用节符号时加数里带着节内偏移（如 .abs(.rodata.str1.1 + a)），
+    // 引用 .LC0 这样的标签时就是标签的位置
+    auto reloc_location = [&](const SymbolDef& def, const Relocation& reloc) -> uint64_t
+    {
+        bool section_symbol = def.sym->name == curr_objs[def.obj_idx]->shdrs[def.shdr_idx].name;
+        return def.sym->offset + (section_symbol ? reloc.addend : 0);
+    };
 
-    for (size_t obj_idx = 0; obj_idx < curr_objs.size(); ++obj_idx) 
+    if (trace)
     {
-        const auto& obj = curr_objs[obj_idx];
-        for (const auto& sym : obj.symbols) 
+        uint64_t bytes = 0;
+        for (const auto& block : merge_blocks) bytes += block.data.size();
+        merge_span.arg("blocks", merge_blocks.size());
+        merge_span.arg("bytes", bytes);
+    }
+    merge_span.end();
+
+    TraceSpan icf_span(trace, "icf");
+    // 相同代码折叠（--icf）：内容相同、重定位也指向相同目标的代码节只保留一份，
+    // 被折叠的节不参与布局，其中的符号都指向保留下来的那一份
+    struct SectionRef
+    {
+        size_t obj_idx;
+        size_t shdr_idx;
+    };
+    vector<vector<SectionRef>> canonical(curr_objs.size()); // 每个输入节折叠到哪个节（没折叠就是自己）
+    for (size_t obj_idx = 0; obj_idx < curr_objs.size(); ++obj_idx)
+    {
+        for (size_t shdr_idx = 0; shdr_idx < curr_objs[obj_idx]->shdrs.size(); ++shdr_idx) canonical[obj_idx].push_back({obj_idx, shdr_idx});
+    }
+    auto is_folded = [&](size_t obj_idx, size_t shdr_idx)
+    {
+        const auto& c = canonical[obj_idx][shdr_idx];
+        return c.obj_idx != obj_idx || c.shdr_idx != shdr_idx;
+    };
+    if (options.icf != "none")
+    {
+        const size_t TEXT = out_sec_id.at(".text");
+        const int64_t NOT_CANDIDATE = -1;
+
+        // safe 模式下，地址被拿去用过的函数（函数指针、地址比较）不能和别的函数共用地址。
+        // FLE 里调用和取地址都是 .rel，只能看重定位前一个字节是不是 call/jmp 的操作码
+        vector<vector<char>> address_taken(curr_objs.size());
+        for (size_t obj_idx = 0; obj_idx < curr_objs.size(); ++obj_idx) address_taken[obj_idx].assign(curr_objs[obj_idx]->shdrs.size(), 0);
+        if (options.icf == "safe")
         {
-            // 将未定义符号名称加入到外部符号集合，然后跳过；
-            // 未定义符号的section,offset和size都为0
-            // 不过这里的未定义符号还不能保证一定是外部符号
-            // 但是他在.so库里面就是正常的符号
-            // 共享库才考虑外部符号
-            if (sym.type == SymbolType::UNDEFINED) 
+            for (size_t obj_idx = 0; obj_idx < curr_objs.size(); ++obj_idx)
             {
-                external_symbols.insert(sym.name);
-                continue;
+                const auto& obj = *curr_objs[obj_idx];
+                for (size_t shdr_idx = 0; shdr_idx < obj.shdrs.size(); ++shdr_idx)
+                {
+                    const auto& shdr = obj.shdrs[shdr_idx];
+                    if (!live[obj_idx][shdr_idx] || shdr.type == 8) continue;
+                    const auto& sec = obj.sections.at(shdr.name);
+                    for (const auto& reloc : sec.relocs)
+                    {
+                        const SymbolDef* def = find_target(obj_idx, reloc.symbol);
+                        if (!def) continue;
+                        bool is_call = reloc.type == RelocationType::R_X86_64_PC32 && reloc.offset > 0 &&
+                                       (sec.data[reloc.offset - 1] == 0xe8 || sec.data[reloc.offset - 1] == 0xe9);
+                        if (!is_call) address_taken[def->obj_idx][def->shdr_idx] = 1;
+                    }
+                }
             }
-            else if(sym.type == SymbolType::WEAK && sym.section != ".text") // 弱变量符号
+            // 共享库导出的函数可能被外面比较地址
+            if (options.shared) global_symbols.for_each([&](uint32_t, const SymbolDef& def) { address_taken[def.obj_idx][def.shdr_idx] = 1; });
+        }
+
+        // 候选：参与链接的非空代码节
+        vector<SectionRef> cands;
+        vector<vector<int64_t>> cand_of(curr_objs.size()); // 输入节 -> 候选下标
+        for (size_t obj_idx = 0; obj_idx < curr_objs.size(); ++obj_idx)
+        {
+            const auto& obj = *curr_objs[obj_idx];
+            cand_of[obj_idx].assign(obj.shdrs.size(), NOT_CANDIDATE);
+            for (size_t shdr_idx = 0; shdr_idx < obj.shdrs.size(); ++shdr_idx)
             {
-                external_symbols.insert(sym.name);
+                const auto& shdr = obj.shdrs[shdr_idx];
+                if (!live[obj_idx][shdr_idx] || shdr.type == 8 || shdr.size == 0) continue;
+                if (match_output_section(shdr) != TEXT || address_taken[obj_idx][shdr_idx]) continue;
+                cand_of[obj_idx][shdr_idx] = cands.size();
+                cands.push_back({obj_idx, shdr_idx});
             }
-            Symbol global_sym = sym;
+        }
 
-            // 局部符号名称要加个文件名前缀
-            if (sym.type == SymbolType::LOCAL) global_sym.name = obj.name + "::" + sym.name;
-            
-            // 计算符号最终地址 = 节起始地址 + 符号在节内偏移
-            for (const auto& head: section_order)
+        // 每条重定位的目标：指向候选节的是“可变”目标，比较的是目标所在的等价类；
+        // 其他目标（非候选节里的定义、外部符号）是“固定”目标，必须完全相同
+        struct RelocKey
+        {
+            uint64_t offset;
+            RelocationType type;
+            int64_t addend;
+            int64_t target_cand; // 目标候选节，NOT_CANDIDATE 表示固定目标
+            uint64_t a, b, c; // 固定目标：(目标文件, 节, 节内偏移) 或 (名字编号)；可变目标：节内偏移
+        };
+        vector<vector<RelocKey>> keys(cands.size());
+        vector<uint64_t> hashes(cands.size());
+        auto mix = [](uint64_t h, uint64_t v) { return (h ^ v) * 1099511628211ull + (h >> 29); };
+        parallel_for(pool, cands.size(), [&](size_t i)
+        {
+            const auto& [obj_idx, shdr_idx] = cands[i];
+            const auto& obj = *curr_objs[obj_idx];
+            const auto& sec = obj.sections.at(obj.shdrs[shdr_idx].name);
+            uint64_t h = hash_name(string_view(reinterpret_cast<const char*>(sec.data.data()), sec.data.size()));
+            for (const auto& reloc : sec.relocs)
             {
-                if (sym.section.starts_with(head))
+                RelocKey key{reloc.offset, reloc.type, reloc.addend, NOT_CANDIDATE, 0, 0, 0};
+                const SymbolDef* def = find_target(obj_idx, reloc.symbol);
+                if (!def) key.a = UINT64_MAX, key.b = names.find(reloc.symbol);
+                else if (cand_of[def->obj_idx][def->shdr_idx] != NOT_CANDIDATE)
+                {
+                    key.target_cand = cand_of[def->obj_idx][def->shdr_idx];
+                    key.c = def->sym->offset;
+                }
+                else if (is_merged(def->obj_idx, def->shdr_idx))
                 {
-                    // 原小节在合并大节中的起始地址
-                    size_t sec_off = pre_sec_addr.at({obj_idx, sym.section});
-                    // 全局变量改个合并节偏移量再把合并节改成一般名称就行
-                    global_sym.offset = sec_off + sym.offset;
-                    global_sym.section = head;
-                    break;
+                    // 合并后相同的字符串、常量在同一个位置
+                    uint64_t loc = reloc_location(*def, reloc);
+                    key.a = UINT64_MAX - 1, key.b = merge_info[def->obj_idx][def->shdr_idx].block;
+                    key.c = merged_offset(def->obj_idx, def->shdr_idx, loc) - (loc - def->sym->offset);
                 }
+                else key.a = def->obj_idx, key.b = def->shdr_idx, key.c = def->sym->offset;
+                h = mix(mix(mix(h, key.offset), static_cast<uint64_t>(key.type)), key.addend);
+                h = mix(mix(mix(mix(h, key.target_cand == NOT_CANDIDATE), key.a), key.b), key.c);
+                keys[i].push_back(key);
             }
+            hashes[i] = h;
+        });
 
-            // 处理符号冲突：强符号覆盖弱符号，局部符号不冲突
-            if (global_symbols.count(global_sym.name)) 
+        // 按哈希分桶，桶内逐个比较确认真的相同，按候选顺序编号，结果与线程数无关
+        vector<size_t> cls(cands.size(), 0);
+        auto regroup = [&](auto&& equal) -> size_t
+        {
+            unordered_map<uint64_t, vector<size_t>> buckets; // 哈希 -> 各等价类的代表
+            vector<size_t> next(cands.size());
+            size_t num_classes = 0;
+            for (size_t i = 0; i < cands.size(); ++i)
             {
-                const auto& existing_sym = global_symbols[global_sym.name];
-                // 冲突规则：GLOBAL > WEAK > LOCAL
-                bool need_replace = false;
-                if (global_sym.type == SymbolType::GLOBAL && existing_sym.type != SymbolType::GLOBAL) 
+                auto& reps = buckets[hashes[i]];
+                auto it = find_if(reps.begin(), reps.end(), [&](size_t rep) { return equal(rep, i); });
+                if (it != reps.end())
                 {
-                    // 当前的为全局符号而表里的不是，那么就要替换
-                    need_replace = true;
-                } 
-                else if (global_sym.type == SymbolType::WEAK && existing_sym.type == SymbolType::LOCAL) 
+                    next[i] = next[*it];
+                    continue;
+                }
+                reps.push_back(i);
+                next[i] = num_classes++;
+            }
+            cls = std::move(next);
+            return num_classes;
+        };
+
+        // 第一轮：只看内容和固定目标，可变目标先当成都相同（乐观假设）
+        size_t num_classes = regroup([&](size_t x, size_t y)
+        {
+            const auto& ox = *curr_objs[cands[x].obj_idx];
+            const auto& oy = *curr_objs[cands[y].obj_idx];
+            const auto& sx = ox.sections.at(ox.shdrs[cands[x].shdr_idx].name);
+            const auto& sy = oy.sections.at(oy.shdrs[cands[y].shdr_idx].name);
+            if (sx.data != sy.data || keys[x].size() != keys[y].size()) return false;
+            for (size_t k = 0; k < keys[x].size(); ++k)
+            {
+                const auto& kx = keys[x][k];
+                const auto& ky = keys[y][k];
+                if (kx.offset != ky.offset || kx.type != ky.type || kx.addend != ky.addend) return false;
+                if ((kx.target_cand == NOT_CANDIDATE) != (ky.target_cand == NOT_CANDIDATE)) return false;
+                if (kx.a != ky.a || kx.b != ky.b || kx.c != ky.c) return false;
+            }
+            return true;
+        });
+
+        // 之后每轮把可变目标所在的等价类也算进哈希，把不再相同的节拆开，直到不动点。
+        // 互相递归的一组相同函数始终互相指向同一个等价类，会留在一起被折叠
+        while (true)
+        {
+            parallel_for(pool, cands.size(), [&](size_t i)
+            {
+                uint64_t h = mix(0, cls[i]);
+                for (const auto& key : keys[i])
                 {
-                    // 当前为弱符号而表里是局部符号，那么也要替换
-                    need_replace = true;
-                } 
-                else if (global_sym.type == existing_sym.type && global_sym.type == SymbolType::GLOBAL) 
+                    if (key.target_cand != NOT_CANDIDATE) h = mix(h, cls[key.target_cand]);
+                }
+                hashes[i] = h;
+            });
+            vector<size_t> prev = cls;
+            size_t refined = regroup([&](size_t x, size_t y)
+            {
+                if (prev[x] != prev[y]) return false;
+                for (size_t k = 0; k < keys[x].size(); ++k)
                 {
-                    // 同时存在两个相同的全局变量，抛出异常
-                    throw runtime_error("Multiple definition of strong symbol: " + sym.name);
+                    if (keys[x][k].target_cand != NOT_CANDIDATE && prev[keys[x][k].target_cand] != prev[keys[y][k].target_cand]) return false;
                 }
+                return true;
+            });
+            if (refined == num_classes) break;
+            num_classes = refined;
+        }
+
+        // 每个等价类保留链接顺序中的第一个节
+        vector<int64_t> leader(num_classes, NOT_CANDIDATE);
+        size_t folded_sections = 0;
+        uint64_t saved_bytes = 0;
+        for (size_t i = 0; i < cands.size(); ++i)
+        {
+            if (leader[cls[i]] == NOT_CANDIDATE)
+            {
+                leader[cls[i]] = i;
+                continue;
+            }
+            canonical[cands[i].obj_idx][cands[i].shdr_idx] = cands[leader[cls[i]]];
+            ++folded_sections;
+            saved_bytes += curr_objs[cands[i].obj_idx]->shdrs[cands[i].shdr_idx].size;
+        }
+        cerr << "icf: folded " << folded_sections << " of " << cands.size() << " sections, saved " << saved_bytes << " bytes" << endl;
+    }
+
+    icf_span.end();
+
+    TraceSpan layout_span(trace, "section merging");
+    // 第一次遍历：合并节 + 分配内存地址
+    // 先算布局：按输入顺序对每个输出节的小节大小做前缀和，得到各小节在合并节中的偏移
+    struct CopyTask
+    {
+        size_t obj_idx;
+        size_t shdr_idx;
+    };
+    vector<CopyTask> copy_tasks;
 
-                // 当前的符号无法替换表内的符号，那么就跳过。
-                if (!need_replace) continue;
+    // 摆放顺序：--symbol-ordering-file 里的符号所在的输入节按文件中的顺序排在各输出节最前面，
+    // 然后是 --call-graph-ordering-file 聚类得到的顺序，其余的（冷代码）按输入顺序跟在后面
+    const size_t UNORDERED = SIZE_MAX;
+    vector<vector<size_t>> priority(curr_objs.size());
+    for (size_t obj_idx = 0; obj_idx < curr_objs.size(); ++obj_idx)
+    {
+        sec_maps[obj_idx].resize(curr_objs[obj_idx]->shdrs.size());
+        priority[obj_idx].assign(curr_objs[obj_idx]->shdrs.size(), UNORDERED);
+    }
+    // 全局符号和各文件的同名局部符号都算
+    auto defs_named = [&](const string& name)
+    {
+        vector<const SymbolDef*> defs;
+        uint32_t name_id = names.find(name);
+        if (name_id == ShardedStringInterner::NONE) return defs;
+        if (const SymbolDef* def = global_symbols.find(name_id)) defs.push_back(def);
+        for (const auto& locals : local_symbols)
+        {
+            if (const SymbolDef* def = locals.find(name_id)) defs.push_back(def);
+        }
+        return defs;
+    };
+    unordered_set<string> ordered_names;
+    for (size_t rank = 0; rank < options.symbol_ordering.size(); ++rank)
+    {
+        const string& name = options.symbol_ordering[rank];
+        if (!ordered_names.insert(name).second)
+        {
+            cerr << "warning: symbol ordering file: symbol '" << name << "' specified multiple times" << endl;
+            continue;
+        }
+        vector<const SymbolDef*> defs = defs_named(name);
+        if (defs.empty())
+        {
+            cerr << "warning: symbol ordering file: no such symbol: " << name << endl;
+            continue;
+        }
+        for (const SymbolDef* def : defs)
+        {
+            size_t& p = priority[def->obj_idx][def->shdr_idx];
+            p = min(p, rank);
+        }
+    }
+    if (!options.call_graph.empty())
+    {
+        // 调用图的节点：边两端符号所在的输入节（被折叠的节换成保留下来的那一份）
+        vector<pair<size_t, size_t>> nodes;
+        map<pair<size_t, size_t>, size_t> node_of;
+        map<pair<size_t, size_t>, uint64_t> edges;
+        unordered_set<string> unknown;
+        auto node = [&](const string& name) -> size_t
+        {
+            uint32_t name_id = names.find(name);
+            const SymbolDef* def = name_id == ShardedStringInterner::NONE ? nullptr : global_symbols.find(name_id);
+            if (!def)
+            {
+                vector<const SymbolDef*> defs = defs_named(name);
+                if (!defs.empty()) def = defs.front();
             }
+            if (!def)
+            {
+                if (unknown.insert(name).second) cerr << "warning: call graph file: no such symbol: " << name << endl;
+                return SIZE_MAX;
+            }
+            auto [obj_idx, shdr_idx] = canonical[def->obj_idx][def->shdr_idx];
+            auto [it, inserted] = node_of.try_emplace({obj_idx, shdr_idx}, nodes.size());
+            if (inserted) nodes.emplace_back(obj_idx, shdr_idx);
+            return it->second;
+        };
+        for (const auto& edge : options.call_graph)
+        {
+            size_t from = node(edge.caller), to = node(edge.callee);
+            if (from == SIZE_MAX || to == SIZE_MAX) continue;
+            // 只排同一个输出节里的节
+            const auto& [from_obj, from_shdr] = nodes[from];
+            const auto& [to_obj, to_shdr] = nodes[to];
+            if (match_output_section(curr_objs[from_obj]->shdrs[from_shdr]) != match_output_section(curr_objs[to_obj]->shdrs[to_shdr])) continue;
+            edges[{from, to}] += edge.weight;
+        }
+        vector<uint64_t> sizes;
+        for (const auto& [obj_idx, shdr_idx] : nodes) sizes.push_back(curr_objs[obj_idx]->shdrs[shdr_idx].size);
+        // 簇不超过一页，热的调用者和被调用者落在同一页里
+        vector<size_t> order = call_graph_order(sizes, edges, page_size);
+        for (size_t k = 0; k < order.size(); ++k)
+        {
+            const auto& [obj_idx, shdr_idx] = nodes[order[k]];
+            size_t& p = priority[obj_idx][shdr_idx];
+            p = min(p, options.symbol_ordering.size() + k);
+        }
+    }
+
+    vector<pair<size_t, size_t>> placement; // (目标文件下标, 节头下标)
+    for (size_t obj_idx = 0; obj_idx < curr_objs.size(); ++obj_idx)
+    {
+        for (size_t shdr_idx = 0; shdr_idx < curr_objs[obj_idx]->shdrs.size(); ++shdr_idx) placement.emplace_back(obj_idx, shdr_idx);
+    }
+    if (!options.symbol_ordering.empty() || !options.call_graph.empty())
+    {
+        stable_sort(placement.begin(), placement.end(), [&](const auto& a, const auto& b)
+        {
+            return priority[a.first][a.second] < priority[b.first][b.second];
+        });
+    }
+
+    // 输入节的对齐：节自己要求的 sh_addralign，.text 节还要满足 --align-functions
+    // 有排序文件时只对齐排在前面的热点节，冷代码照旧紧挨着放
+    auto align_up = [](uint64_t addr, uint64_t align) -> uint64_t
+    {
+        return (addr + align - 1) / align * align;
+    };
+    bool ordered = !options.symbol_ordering.empty() || !options.call_graph.empty();
+    auto input_align = [&](size_t obj_idx, size_t shdr_idx) -> uint64_t
+    {
+        const auto& shdr = curr_objs[obj_idx]->shdrs[shdr_idx];
+        uint64_t align = max<uint64_t>(shdr.addralign, 1);
+        bool hot = !ordered || priority[obj_idx][shdr_idx] != UNORDERED;
+        bool code = output_specs[match_output_section(shdr)].shdr_flags & SHF::EXEC;
+        if (code && hot) align = max(align, options.align_functions);
+        return align;
+    };
+    vector<uint64_t> out_align(output_specs.size(), 1); // 输出节的对齐：其中输入节对齐的最大值
 
-            global_symbols[global_sym.name] = global_sym;
+    // 按摆放顺序记录各小节的大小
+    for (const auto& [obj_idx, shdr_idx] : placement)
+    {
+        const auto& obj = *curr_objs[obj_idx];
+        const auto& shdr = obj.shdrs[shdr_idx];
+        size_t out_id = match_output_section(shdr);
+        // 被回收、被折叠的节不占位置，可合并节的内容在合并块里
+        if (!live[obj_idx][shdr_idx] || is_folded(obj_idx, shdr_idx) || is_merged(obj_idx, shdr_idx))
+        {
+            sec_maps[obj_idx][shdr_idx] = {out_id, 0, 0, 0};
+            continue;
         }
+        // 存下当前小节在合并大节后的初始位置，先补齐到它要求的对齐
+        uint64_t align = input_align(obj_idx, shdr_idx);
+        out_align[out_id] = max(out_align[out_id], align);
+        global_sections[out_id].size = align_up(global_sections[out_id].size, align);
+        uint64_t capacity = shdr.size + slot_padding(out_id);
+        sec_maps[obj_idx][shdr_idx] = {out_id, global_sections[out_id].size, 0, capacity};
+        // 相应的，更新到下一个小节的初始位置
+        global_sections[out_id].size += capacity;
+        if (shdr.type == 8) continue;
+
+        // 就不能合并重定位标，不然program还以为那个地方是重定位的
+        merged_sec[out_id].has_symbols |= obj.sections.at(shdr.name).has_symbols;
+        copy_tasks.push_back({obj_idx, shdr_idx});
     }
 
+    // 合并块放在各自输出节的末尾
+    for (auto& block : merge_blocks)
+    {
+        auto& size = global_sections[block.out_id].size;
+        size = align_up(size, block.align);
+        out_align[block.out_id] = max<uint64_t>(out_align[block.out_id], block.align);
+        block.out_offset = size;
+        size += block.data.size();
+    }
+
+    // 再合并内存：合并节一次分配到最终大小，各小节并行拷贝到自己的偏移处
+    // 重定位不用补0了，原本的输入已经补好了。
+    // 代码节里对齐留下的空隙填 int3（0xcc），万一执行到了立即陷入，其余的节补 0
+    for (size_t id = 0; id < output_specs.size(); ++id)
+    {
+        uint8_t fill = (output_specs[id].shdr_flags & SHF::EXEC) ? 0xcc : 0;
+        if (!output_specs[id].nobits) merged_sec[id].data.resize(global_sections[id].size, fill);
+    }
+    parallel_for(pool, copy_tasks.size(), [&](size_t task_idx)
+    {
+        const auto& task = copy_tasks[task_idx];
+        const auto& obj = *curr_objs[task.obj_idx];
+        const auto& shdr = obj.shdrs[task.shdr_idx];
+        const auto& sec = obj.sections.at(shdr.name);
+        const auto& m = sec_maps[task.obj_idx][task.shdr_idx];
+        size_t len = min<size_t>(sec.data.size(), shdr.size);
+        if (len > 0) memcpy(merged_sec[m.out_id].data.data() + m.out_offset, sec.data.data(), len);
+    });
+    for (const auto& block : merge_blocks)
+    {
+        if (!block.data.empty()) memcpy(merged_sec[block.out_id].data.data() + block.out_offset, block.data.data(), block.data.size());
+    }
+
+    if (trace)
+    {
+        uint64_t bytes = 0;
+        for (const auto& sec : global_sections) bytes += sec.size;
+        layout_span.arg("input sections", copy_tasks.size());
+        layout_span.arg("bytes", bytes);
+    }
+    layout_span.end();
+
+    TraceSpan got_span(trace, "GOT/PLT synthesis");
     // 把 external_symbols 里面实际上不是外部符号的去掉
     for (size_t obj_idx = 0; obj_idx < curr_objs.size(); ++obj_idx) 
     {
-        auto& obj = curr_objs[obj_idx];
+        const auto& obj = *curr_objs[obj_idx];
         for(const auto& shdr : obj.shdrs)
         {
             if(shdr.type == 8) continue;
@@ -254,303 +1186,657 @@ FLEObject FLE_ld(const std::vector<FLEObject>& objects, const LinkerOptions& opt
             auto& sec = obj.sections.at(sec_name);
             for (const auto& reloc : sec.relocs)
             {
-                if(global_symbols.count(reloc.symbol) || (!so_symbol_section.count(reloc.symbol)))
+                if(options.shared == false)
                 {
                     // 把未定义但不是外部符号的去掉了
-                    if(options.shared == false) external_symbols.erase(reloc.symbol);
+                    if(find_global(reloc.symbol) || (!so_symbol_section.count(reloc.symbol))) external_symbols.erase(reloc.symbol);
+                }
+                else if(const SymbolDef* def = find_global(reloc.symbol))
+                {
+                    // 共享库里只有弱变量留给运行时决定，其余在本模块里有定义的直接访问，不经 PLT/GOT
+                    if(def->type != SymbolType::WEAK || def->sym->section == ".text") external_symbols.erase(reloc.symbol);
                 }
             }
         }
     }
 
+    // 只给活的节真正引用到的外部符号分配表项；
+    // 共享库链接时没有别的共享库告诉我们符号的类型，被 call/jmp（PC32）引用的就当作函数
+    unordered_set<string> referenced, called;
+    for (size_t obj_idx = 0; obj_idx < curr_objs.size(); ++obj_idx)
+    {
+        const auto& obj = *curr_objs[obj_idx];
+        for (size_t shdr_idx = 0; shdr_idx < obj.shdrs.size(); ++shdr_idx)
+        {
+            const auto& shdr = obj.shdrs[shdr_idx];
+            if (!live[obj_idx][shdr_idx] || is_folded(obj_idx, shdr_idx) || shdr.type == 8) continue;
+            for (const auto& reloc : obj.sections.at(shdr.name).relocs)
+            {
+                referenced.insert(reloc.symbol);
+                if (reloc.type == RelocationType::R_X86_64_PC32) called.insert(reloc.symbol);
+            }
+        }
+    }
+    for (auto it = external_symbols.begin(); it != external_symbols.end();)
+    {
+        if (referenced.count(*it)) ++it;
+        else it = external_symbols.erase(it);
+    }
+    auto is_function = [&](const string& name)
+    {
+        auto it = so_symbol_section.find(name);
+        return it != so_symbol_section.end() ? it->second == ".text" : called.count(name) > 0;
+    };
+
     unordered_map<string,int> got_sym;
     unordered_map<string,int> plt_sym;
     int got_idx = 0,plt_idx = 0;
 
-    // 先构建符号与GOT表和PLT表之间的映射关系
-    for(const auto& sym_name : external_symbols)
+    // 先构建符号与GOT表和PLT表之间的映射关系：每个外部符号一个 GOT 槽位，外部函数再加一个 PLT 表项
+    // 按名字排序分配，输出与哈希表的遍历顺序无关
+    vector<string> imports(external_symbols.begin(), external_symbols.end());
+    sort(imports.begin(), imports.end());
+    for(const auto& sym_name : imports)
     {
-        if(so_symbol_section[sym_name] == ".text")
-        {
-            // 外部函数
-            got_sym[sym_name] = got_idx;
-            plt_sym[sym_name] = plt_idx;  
-            got_idx++;
-            plt_idx++;
-        }
-        else
+        got_sym[sym_name] = got_idx++;
+        if(is_function(sym_name)) plt_sym[sym_name] = plt_idx++;
+    }
+
+    // 经 GOT 访问本模块里定义的符号：.gotpcrelx 且指令可以改写时直接访问符号，不占 GOT；
+    // 其余的（.gotpcrel，或者认不出的指令）仍然需要一个存放符号地址的 GOT 槽位，每个定义一个
+    auto is_got_reloc = [](RelocationType type)
+    {
+        return type == RelocationType::R_X86_64_GOTPCREL || type == RelocationType::R_X86_64_GOTPCRELX;
+    };
+    auto relaxation = [](const FLESection& sec, const Relocation& reloc)
+    {
+        if (reloc.type != RelocationType::R_X86_64_GOTPCRELX) return GotRelax::NONE;
+        return gotpcrelx_relaxation(sec.data.data() + reloc.offset, reloc.offset);
+    };
+    vector<const SymbolDef*> local_got; // 本模块符号的 GOT 槽位，排在外部符号的槽位后面
+    unordered_map<const Symbol*, int> local_got_slot;
+    for (size_t obj_idx = 0; obj_idx < curr_objs.size(); ++obj_idx)
+    {
+        const auto& obj = *curr_objs[obj_idx];
+        for (size_t shdr_idx = 0; shdr_idx < obj.shdrs.size(); ++shdr_idx)
         {
-            // 外部数据
-            got_sym[sym_name] = got_idx;
-            got_idx++;
+            const auto& shdr = obj.shdrs[shdr_idx];
+            if (shdr.type == 8 || !live[obj_idx][shdr_idx] || is_folded(obj_idx, shdr_idx)) continue;
+            const auto& sec = obj.sections.at(shdr.name);
+            for (const auto& reloc : sec.relocs)
+            {
+                if (!is_got_reloc(reloc.type) || relaxation(sec, reloc) != GotRelax::NONE) continue;
+                // 与重定位时的解析顺序一致：局部符号、外部符号、全局符号
+                uint32_t name_id = names.find(reloc.symbol);
+                const SymbolDef* def = name_id == ShardedStringInterner::NONE ? nullptr : local_symbols[obj_idx].find(name_id);
+                if (!def && external_symbols.count(reloc.symbol)) continue;
+                if (!def) def = find_global(reloc.symbol);
+                if (!def || local_got_slot.count(def->sym)) continue;
+                local_got_slot[def->sym] = got_idx++;
+                local_got.push_back(def);
+            }
         }
     }
 
     // 然后由于要算地址，这两个表占内存，先填充0吧
-    merged_sec[".got"].data.resize(got_sym.size() * 8,0);
-    merged_sec[".plt"].data.resize(plt_sym.size() * 6,0);
-    global_sections[".got"].size = merged_sec[".got"].data.size();
-    global_sections[".plt"].size = merged_sec[".plt"].data.size();
+    merged_sec[GOT].data.resize(got_idx * 8,0);
+    merged_sec[PLT].data.resize(plt_sym.size() * 6,0);
+    global_sections[GOT].size = merged_sec[GOT].data.size();
+    global_sections[PLT].size = merged_sec[PLT].data.size();
+
+    got_span.arg("got entries", got_idx);
+    got_span.arg("plt entries", plt_sym.size());
+    got_span.end();
+    if (stats)
+    {
+        stats->got_entries = got_idx;
+        stats->plt_entries = plt_sym.size();
+    }
 
+    TraceSpan addr_span(trace, "assign addresses");
     // 分配节的地址
-    for (const auto& sec_name : section_order) 
+    uint32_t segment_flags = 0; // 紧凑布局下当前段的权限，0 表示还没有段
+    for (size_t id = 0; id < output_specs.size(); ++id) 
     {
         // 读取节
-        auto& sec = merged_sec[sec_name];
-        // 记录当前节的初始位置
-        global_sections[sec_name].addr = current_vaddr;
+        auto& sec = merged_sec[id];
 
         // 更新节大小（.bss 节从输入节累计大小）
-        if (sec_name.starts_with(".bss")) 
+        if (output_specs[id].nobits) 
         {
             // resize（a,b） 表示新增a个全部初始化为b的元素
-            sec.data.resize(global_sections[".bss"].size, 0); // 填充0占位
+            sec.data.resize(global_sections[id].size, 0); // 填充0占位
+        }
+
+        if (options.compact_segments)
+        {
+            // 权限变了才另起一个按页对齐的段，同一段里的节按自己的对齐紧挨着放
+            if (!sec.data.empty())
+            {
+                if (segment_flags != 0 && segment_flags != output_specs[id].phdr_flags) current_vaddr = align_up(current_vaddr, page_size);
+                current_vaddr = align_up(current_vaddr, max(output_specs[id].align, out_align[id]));
+                segment_flags = output_specs[id].phdr_flags;
+            }
+            global_sections[id].addr = current_vaddr;
+            current_vaddr += sec.data.size();
+            continue;
         }
 
+        // 记录当前节的初始位置
+        global_sections[id].addr = current_vaddr;
+
         // 推进当前地址（按节实际大小分配）
         // 也就是合并大节的初始位置
         // 而且地址要满足为 页大小 的整数倍
         current_vaddr += sec.data.size();
-        current_vaddr = (current_vaddr + page_size - 1) / page_size * page_size;
+        current_vaddr = align_up(current_vaddr, page_size);
     }
 
+    // 地址确定后，补全每个输入节的运行时地址
+    for (auto& maps : sec_maps)
+    {
+        for (auto& m : maps) m.addr = global_sections[m.out_id].addr + m.out_offset;
+    }
+    // 被折叠的节就是保留下来的那一份
+    for (size_t obj_idx = 0; obj_idx < curr_objs.size(); ++obj_idx)
+    {
+        for (size_t shdr_idx = 0; shdr_idx < sec_maps[obj_idx].size(); ++shdr_idx)
+        {
+            if (!is_folded(obj_idx, shdr_idx)) continue;
+            const auto& c = canonical[obj_idx][shdr_idx];
+            sec_maps[obj_idx][shdr_idx] = sec_maps[c.obj_idx][c.shdr_idx];
+        }
+    }
+    // 输入节里的位置在输出节中的偏移
+    auto out_offset = [&](size_t obj_idx, size_t shdr_idx, uint64_t offset) -> uint64_t
+    {
+        if (!is_merged(obj_idx, shdr_idx)) return sec_maps[obj_idx][shdr_idx].out_offset + offset;
+        return merge_blocks[merge_info[obj_idx][shdr_idx].block].out_offset + merged_offset(obj_idx, shdr_idx, offset);
+    };
+    // 符号地址 = 所在输入节的运行时地址 + 节内偏移
+    auto def_addr = [&](const SymbolDef& def) -> uint64_t
+    {
+        if (is_merged(def.obj_idx, def.shdr_idx))
+        {
+            return global_sections[sec_maps[def.obj_idx][def.shdr_idx].out_id].addr + out_offset(def.obj_idx, def.shdr_idx, def.sym->offset);
+        }
+        return sec_maps[def.obj_idx][def.shdr_idx].addr + def.sym->offset;
+    };
+
     // 得到 .got 的地址后进行重定位
-    // 先构建符号与GOT表和PLT表之间的映射关系
-    for(const auto& sym_name : external_symbols)
-    {
-        if(so_symbol_section[sym_name] == ".text")
-        {
-            // 外部函数
-            // 创建重定位项
-            Relocation reloc;
-            reloc.type = RelocationType::R_X86_64_64;
-            reloc.addend = 0;
-            reloc.symbol = sym_name;
-            reloc.offset = global_sections[".got"].addr;
-            result.dyn_relocs.push_back(reloc);
-        }
-        else
-        {
-            // 外部数据
-            // 创建重定位项
-            Relocation reloc;
-            reloc.type = RelocationType::R_X86_64_64;
-            reloc.addend = 0;
-            reloc.symbol = sym_name;
-            reloc.offset = global_sections[".got"].addr;
-            result.dyn_relocs.push_back(reloc);
-        }
-        
-    }    
+    // 每个 GOT 槽位一条动态重定位，运行时把符号地址填进这个槽位
+    for(const auto& sym_name : imports)
+    {
+        Relocation reloc;
+        reloc.type = RelocationType::R_X86_64_64;
+        reloc.addend = 0;
+        reloc.symbol = sym_name;
+        reloc.offset = global_sections[GOT].addr + got_sym[sym_name] * 8;
+        result.dyn_relocs.push_back(reloc);
+    }
 
     // 生成PLT stub 然后填入plt表中
     for(auto& [sym_name,plt_idx] : plt_sym)
     {
-        int64_t got_addr = global_sections[".got"].addr + got_sym[sym_name] * 8;
-        int64_t plt_addr = global_sections[".plt"].addr + plt_idx * 6;
+        int64_t got_addr = global_sections[GOT].addr + got_sym[sym_name] * 8;
+        int64_t plt_addr = global_sections[PLT].addr + plt_idx * 6;
         int64_t got_offset = got_addr - (plt_addr + 6) ;
         vector<uint8_t> stub = generate_plt_stub(got_offset);
         // 更新plt中的数据
         for(int i = 0;i < 6;i++)
         {
-            merged_sec[".plt"].data[plt_idx * 6 + i]  = stub[i];   
+            merged_sec[PLT].data[plt_idx * 6 + i]  = stub[i];   
+
+        }
+    }
 
+    // 本模块符号的 GOT 槽位：可执行文件的地址在链接时就确定了，直接填进去；
+    // 共享库的加载地址要到运行时才知道，按名字生成动态重定位
+    for (const SymbolDef* def : local_got)
+    {
+        int slot = local_got_slot.at(def->sym);
+        if (!options.shared)
+        {
+            store_le64(merged_sec[GOT].data.data() + slot * 8, def_addr(*def));
+            continue;
+        }
+        if (def->type == SymbolType::LOCAL)
+        {
+            throw runtime_error("Cannot access local symbol " + def->sym->name + " through the GOT in a shared library");
         }
+        Relocation reloc;
+        reloc.type = RelocationType::R_X86_64_64;
+        reloc.addend = 0;
+        reloc.symbol = def->sym->name;
+        reloc.offset = global_sections[GOT].addr + slot * 8;
+        result.dyn_relocs.push_back(reloc);
     }
 
-    // 第三次遍历：处理重定位
+    addr_span.end();
+
+    TraceSpan reloc_span(trace, "relocation");
+    // 第二次遍历：处理重定位
+    // 布局确定后每个输入小节在合并节里占据互不重叠的区间，
+    // 所以可以按输入小节并行地写入，结果与执行顺序无关。
+    struct RelocTask
+    {
+        size_t obj_idx;
+        size_t shdr_idx;
+    };
+    vector<RelocTask> reloc_tasks;
     for (size_t obj_idx = 0; obj_idx < curr_objs.size(); ++obj_idx) 
     {
-        auto& obj = curr_objs[obj_idx];
-        for(const auto& shdr : obj.shdrs)
+        const auto& obj = *curr_objs[obj_idx];
+        for(size_t shdr_idx = 0; shdr_idx < obj.shdrs.size(); ++shdr_idx)
         {
+            const auto& shdr = obj.shdrs[shdr_idx];
             if(shdr.type == 8) continue;
-            string sec_name = shdr.name;
-            auto& sec = obj.sections.at(sec_name);
-            // 合并节内小节偏移量
-            int64_t curr_off = pre_sec_addr.at({obj_idx, sec_name});
-            int64_t curr_addr;
-            string now_sec;
-            // 得到当前内存地址（但不含偏移）
-            for(auto head : section_order)
-            {
-                if(sec_name.starts_with(head))
+            if(!live[obj_idx][shdr_idx] || is_folded(obj_idx, shdr_idx) || is_merged(obj_idx, shdr_idx) || obj.sections.at(shdr.name).relocs.empty()) continue;
+            reloc_tasks.push_back({obj_idx, shdr_idx});
+        }
+    }
+
+    // 并行阶段只读地查 GOT/PLT 下标，表里没有的返回 -1。
+    // 外部数据没有 PLT 表项，对它的 PC32 引用（非 -fPIC 代码访问共享库里的变量）要报错，不能落到第 0 项上
+    auto slot_of = [](const unordered_map<string,int>& table, const string& name) -> int64_t
+    {
+        auto it = table.find(name);
+        return it == table.end() ? -1 : it->second;
+    };
+    const uint32_t NO_SLOT = UINT32_MAX; // 外部符号没有对应的 PLT/GOT 表项
+
+    // 增量链接要记下每处对全局符号的引用，符号挪动时只重做这些重定位
+    // 每个任务各写各的，最后按任务顺序汇总，结果与线程数无关
+    vector<vector<pair<string, LinkLayout::Fixup>>> task_fixups(layout ? reloc_tasks.size() : 0);
+
+    parallel_for(pool, reloc_tasks.size(), [&](size_t task_idx)
+    {
+        size_t obj_idx = reloc_tasks[task_idx].obj_idx;
+        const auto& obj = *curr_objs[obj_idx];
+        const auto& shdr = obj.shdrs[reloc_tasks[task_idx].shdr_idx];
+        auto& sec = obj.sections.at(shdr.name);
+        TraceSpan task_span(trace, "relocate", obj.name);
+        task_span.arg("relocations", sec.relocs.size());
+        // 当前小节的映射记录：合并节内偏移量和运行时地址
+        const auto& m = sec_maps[obj_idx][reloc_tasks[task_idx].shdr_idx];
+        int64_t curr_off = m.out_offset;
+        int64_t curr_addr = m.addr;
+        auto& out_data = merged_sec[m.out_id].data;
+
+        // 先把这个小节的重定位解析成 (偏移, 符号编号, 加数)，按类型分组，再交给批量引擎
+        // 同一个符号在一个小节里常常被引用多次（比如反复调用 printf），只解析一次
+        struct Target
+        {
+            bool skip; // 共享库里找不到定义的符号，留给运行时
+            bool external; // 外部符号，经 PLT/GOT 访问
+            uint32_t id; // 普通符号的地址 / 外部符号的 PLT 地址（没有 PLT 表项时为 NO_SLOT）
+            uint32_t got_id; // 外部符号的 GOT 地址 / 本模块符号的 GOT 槽位地址（经 GOT 访问又不能改写时）
+            bool global; // 解析到的是全局符号（不是本文件的局部符号）
+            const SymbolDef* merged; // 定义在可合并节里，指向的表项要按每条重定位单独换算
+        };
+        vector<uint64_t> sym_addr; // symbol_id -> 地址
+        unordered_map<string, Target> targets;
+        auto resolve = [&](const string& name) -> Target
+        {
+            // 先试一试本文件的局部符号
+            uint32_t name_id = names.find(name);
+            const SymbolDef* def = name_id == ShardedStringInterner::NONE ? nullptr : local_symbols[obj_idx].find(name_id);
+
+            // 共享库下对于外部符号的重定位：函数走 PLT，数据走 GOT
+            if(!def && external_symbols.count(name))
+            {
+                uint32_t plt_id = NO_SLOT, got_id = NO_SLOT;
+                if (int64_t slot = slot_of(plt_sym, name); slot >= 0)
+                {
+                    plt_id = sym_addr.size();
+                    sym_addr.push_back(global_sections[PLT].addr + slot * 6);
+                }
+                if (int64_t slot = slot_of(got_sym, name); slot >= 0)
                 {
-                    now_sec = head;
-                    curr_addr = global_sections[head].addr + curr_off;
-                    break;
+                    got_id = sym_addr.size();
+                    sym_addr.push_back(global_sections[GOT].addr + slot * 8);
                 }
+                return {false, true, plt_id, got_id, false, nullptr};
             }
-            for (const auto& reloc : sec.relocs)
+
+            bool global = !def;
+            if(!def && name_id != ShardedStringInterner::NONE) def = global_symbols.find(name_id);
+
+            // 静态链接下重定位的符号不存在，报错离开
+            if(!def)
+            {
+                if(options.shared) return {true, false, 0, 0, false, nullptr};
+                throw runtime_error("Relocation points to an undefined symbol: " + name);
+            }
+
+            // 要找当前符号的地址，而不是要填在的内存的地方
+            uint32_t id = sym_addr.size();
+            sym_addr.push_back(def_addr(*def));
+            // 不能改写的 GOT 访问用这个定义自己的 GOT 槽位
+            uint32_t got_id = 0;
+            if (auto it = local_got_slot.find(def->sym); it != local_got_slot.end())
             {
-                // 先试一试局部符号
-                string sym_name = obj.name + "::" + reloc.symbol;
+                got_id = sym_addr.size();
+                sym_addr.push_back(global_sections[GOT].addr + it->second * 8);
+            }
+            return {false, false, id, got_id, global, is_merged(def->obj_idx, def->shdr_idx) ? def : nullptr};
+        };
 
-                // 全局符号表里面没这个符号名的局部符号形式，说明他不是局部变量
-                if(!global_symbols.count(sym_name))
+        RelocBatches batches;
+        for (const auto& reloc : sec.relocs)
+        {
+            auto it = targets.find(reloc.symbol);
+            if(it == targets.end()) it = targets.emplace(reloc.symbol, resolve(reloc.symbol)).first;
+            const Target& target = it->second;
+            if(target.skip) continue;
+
+            if(target.external)
+            {
+                // 外部函数填 PLT 的相对地址，外部数据填 GOT 的相对地址，都是 32 位 S + A - P
+                bool via_plt = reloc.type == RelocationType::R_X86_64_PC32;
+                uint32_t id = via_plt ? target.id : target.got_id;
+                if (id == NO_SLOT) throw runtime_error(string("no ") + (via_plt ? "PLT" : "GOT") + " slot for " + reloc.symbol +
+                                                       (via_plt ? " (PC32 reference to imported data, compile with -fPIC)" : ""));
+                batches[RelocationType::R_X86_64_PC32].push(reloc.offset, id, reloc.addend);
+            }
+            else if(is_got_reloc(reloc.type))
+            {
+                GotRelax kind = relaxation(sec, reloc);
+                if (kind == GotRelax::NONE)
                 {
-                    sym_name = reloc.symbol;
+                    // 槽位里放的是符号地址，符号挪动时由槽位自己的记录修补
+                    batches[RelocationType::R_X86_64_PC32].push(reloc.offset, target.got_id, reloc.addend);
+                    continue;
                 }
-
-                // 共享库下对于外部符号的重定位
-                if(external_symbols.count(sym_name))
+                // 改写成直接访问符号的指令，之后就是普通的 PC32 重定位
+                int64_t shift = relax_gotpcrelx(out_data.data() + curr_off + reloc.offset, kind);
+                batches[RelocationType::R_X86_64_PC32].push(reloc.offset + shift, target.id, reloc.addend);
+                if (layout && target.global)
                 {
-                    int64_t reloc_value;
-                    if(reloc.type == RelocationType::R_X86_64_PC32) // 外部函数
-                    {
-                        int64_t plt_addr = global_sections[".plt"].addr + plt_sym[sym_name] * 6;
-                        int64_t reloc_addr = curr_addr + reloc.offset;
-                        reloc_value = static_cast<int64_t>(plt_addr + reloc.addend - reloc_addr);
-                        cout << sym_name << " " << reloc_value << " " << reloc_addr << " "  << plt_addr << " " << reloc.addend << endl;
-                    }
-                    else // 外部数据
-                    {
-                        int64_t got_addr = global_sections[".got"].addr + got_sym[sym_name] * 8;
-                        int64_t reloc_addr = curr_addr + reloc.offset;
-                        reloc_value = static_cast<int64_t>(got_addr + reloc.addend - reloc_addr);
-                    }
-
-                    // 重定位32位相对地址
-                    merged_sec[now_sec].data[curr_off + reloc.offset]     = reloc_value & 0xFF;         // 最低字节
-                    merged_sec[now_sec].data[curr_off + reloc.offset + 1] = (reloc_value >> 8) & 0xFF;
-                    merged_sec[now_sec].data[curr_off + reloc.offset + 2] = (reloc_value >> 16) & 0xFF;
-                    merged_sec[now_sec].data[curr_off + reloc.offset + 3] = (reloc_value >> 24) & 0xFF; // 最高字节  
+                    task_fixups[task_idx].push_back({reloc.symbol, {obj_idx, curr_addr + reloc.offset + shift, RelocationType::R_X86_64_PC32, reloc.addend}});
                 }
-                else // 静态链接重定位
+            }
+            else if(target.merged)
+            {
+                // 换算出指向的表项的新位置，再扣掉加数里的节内偏移，批量引擎加回加数后正好指向它
+                const SymbolDef& def = *target.merged;
+                uint64_t loc = reloc_location(def, reloc);
+                uint32_t id = sym_addr.size();
+                sym_addr.push_back(global_sections[sec_maps[def.obj_idx][def.shdr_idx].out_id].addr +
+                                   out_offset(def.obj_idx, def.shdr_idx, loc) - (loc - def.sym->offset));
+                batches[reloc.type].push(reloc.offset, id, reloc.addend);
+            }
+            else
+            {
+                batches[reloc.type].push(reloc.offset, target.id, reloc.addend);
+                if (layout && target.global)
                 {
-                    // 静态链接下重定位的符号不存在，报错离开
-                    if(!global_symbols.count(sym_name))
-                    {
-                        if(options.shared)
-                        {
-                            continue;
-                        }
-                        else
-                        {
-                            throw runtime_error("Relocation points to an undefined symbol: " + sym_name);
-                        }
-                    }
-                    
-                    // 要找当前符号的地址，而不是要填在的内存的地方
-                    int64_t S = global_symbols.at(sym_name).offset + global_sections[global_symbols.at(sym_name).section].addr;
-                    // 小偏移量
-                    int64_t A = reloc.addend;
-                    // 重定位的内存地址
-                    int64_t P = curr_addr + reloc.offset;
-                    // 按小端序写入节数据
-                    if(reloc.type == RelocationType::R_X86_64_64)
-                    {
-                        uint64_t reloc_value = static_cast<uint64_t>(S + A);
-                        // 64位绝对地址
-                        merged_sec[now_sec].data[curr_off + reloc.offset]     = (reloc_value) & 0xFF;         // 最低字节
-                        merged_sec[now_sec].data[curr_off + reloc.offset + 1] = (reloc_value >> 8) & 0xFF;
-                        merged_sec[now_sec].data[curr_off + reloc.offset + 2] = (reloc_value >> 16) & 0xFF;
-                        merged_sec[now_sec].data[curr_off + reloc.offset + 3] = (reloc_value >> 24) & 0xFF;
-                        merged_sec[now_sec].data[curr_off + reloc.offset + 4] = (reloc_value >> 32) & 0xFF;  
-                        merged_sec[now_sec].data[curr_off + reloc.offset + 5] = (reloc_value >> 40) & 0xFF;
-                        merged_sec[now_sec].data[curr_off + reloc.offset + 6] = (reloc_value >> 48) & 0xFF;
-                        merged_sec[now_sec].data[curr_off + reloc.offset + 7] = (reloc_value >> 56) & 0xFF; // 最高字节
-                    }
-                    else if(reloc.type == RelocationType::R_X86_64_32 || reloc.type == RelocationType::R_X86_64_32S)
-                    {
-                        uint32_t reloc_value = static_cast<uint32_t>(S + A);
-                        // 32位绝对地址
-                        merged_sec[now_sec].data[curr_off + reloc.offset]     = reloc_value & 0xFF;         // 最低字节
-                        merged_sec[now_sec].data[curr_off + reloc.offset + 1] = (reloc_value >> 8) & 0xFF;
-                        merged_sec[now_sec].data[curr_off + reloc.offset + 2] = (reloc_value >> 16) & 0xFF;
-                        merged_sec[now_sec].data[curr_off + reloc.offset + 3] = (reloc_value >> 24) & 0xFF; // 最高字节
-                    }
-                    else //  (reloc.type == RelocationType::R_X86_64_PC32)
-                    {
-                        int32_t reloc_value = static_cast<int64_t>(S + A - P);
-                        // 32位相对地址
-                        merged_sec[now_sec].data[curr_off + reloc.offset]     = reloc_value & 0xFF;         // 最低字节
-                        merged_sec[now_sec].data[curr_off + reloc.offset + 1] = (reloc_value >> 8) & 0xFF;
-                        merged_sec[now_sec].data[curr_off + reloc.offset + 2] = (reloc_value >> 16) & 0xFF;
-                        merged_sec[now_sec].data[curr_off + reloc.offset + 3] = (reloc_value >> 24) & 0xFF; // 最高字节
-                    }   
+                    task_fixups[task_idx].push_back({reloc.symbol, {obj_idx, curr_addr + reloc.offset, reloc.type, reloc.addend}});
                 }
             }
         }
+
+        // P = 小节运行时地址 + 偏移；按小端序写入合并节中这个小节的位置
+        vector<uint64_t> scratch;
+        apply_reloc_batches(batches, sym_addr.data(), curr_addr, out_data.data() + curr_off, scratch);
+    });
+
+if (trace || stats)
+{
+    size_t relocs = 0;
+    for (const auto& task : reloc_tasks)
+    {
+        const auto& sec_relocs = curr_objs[task.obj_idx]->sections.at(curr_objs[task.obj_idx]->shdrs[task.shdr_idx].name).relocs;
+        relocs += sec_relocs.size();
+        if (stats)
+        {
+            for (const auto& reloc : sec_relocs) ++stats->relocations[static_cast<size_t>(reloc.type)];
+        }
     }
+    reloc_span.arg("sections", reloc_tasks.size());
+    reloc_span.arg("relocations", relocs);
+}
+reloc_span.end();
 
 // 生成程序头(phdrs)
-for (const auto& head: section_order)
+for (size_t id = 0; id < output_specs.size(); ++id)
 {
-    if(merged_sec[head].data.size() == 0) continue;
-    // 保存合并后的节
-    result.sections[head] = merged_sec[head];
+    const auto& spec = output_specs[id];
+    if(merged_sec[id].data.size() == 0) continue;
+    // 保存合并后的节（移动过去，合并节之后不再使用）
+    result.sections[spec.name] = std::move(merged_sec[id]);
+
+    // 紧凑布局下权限相同的节合成一个段，段以其中第一个节命名，覆盖到最后一个节的末尾
+    if (options.compact_segments && !result.phdrs.empty() && result.phdrs.back().flags == spec.phdr_flags)
+    {
+        result.phdrs.back().size = global_sections[id].addr + global_sections[id].size - result.phdrs.back().vaddr;
+        continue;
+    }
 
     ProgramHeader phdr;
-    phdr.name = head;
-    phdr.vaddr = global_sections[head].addr;
-    phdr.size = global_sections[head].size;
-    if (head == ".text")  phdr.flags = PHF::R | PHF::X;
-    else if (head == ".rodata")  phdr.flags = static_cast<uint32_t>(PHF::R);
-    else if (head == ".data")  phdr.flags = PHF::R | PHF::W;
-    else if (head == ".bss")  phdr.flags = PHF::R | PHF::W;
-    else if (head == ".got") phdr.flags = PHF::R | PHF::W;
-    else if (head == ".plt") phdr.flags = PHF::R | PHF::X;
+    phdr.name = spec.name;
+    phdr.vaddr = global_sections[id].addr;
+    phdr.size = global_sections[id].size;
+    phdr.flags = spec.phdr_flags;
     result.phdrs.push_back(phdr);
 }
 
 // 构建输出节头（shdrs）
-for (const auto& [sec_name, sec] : merged_sec) 
+for (const auto& [sec_name, sec] : result.sections) 
 {
+    const size_t id = out_sec_id.at(sec_name);
+    const auto& spec = output_specs[id];
     SectionHeader shdr;
     shdr.name = sec_name;
     // 只有bss不用文件空间设为8（SHT_NOBITS），其他的设为1（SHT_PROGBITS）
-    shdr.type = (sec_name.starts_with(".bss")) ? 8 : 1;
+    shdr.type = spec.nobits ? 8 : 1;
     // 地址读一下
-    shdr.addr = global_sections[sec_name].addr;
+    shdr.addr = global_sections[id].addr;
     // 节在文件中的位置，基础实现简化为0
     shdr.offset = 0; 
+    shdr.addralign = max(spec.align, out_align[id]);
     // 大小等于data的size，一个元素是一个字节
     shdr.size = sec.data.size();
     if(sec.data.size() == 0) continue;
     // 节头标志
-    uint32_t flags = 0;
-    if (sec_name == ".text" || sec_name == ".plt") {
-        // .text/.plt是代码段：需要分配内存 + 可执行
-        flags = SHF::ALLOC | SHF::EXEC;
-    } 
-    else if (sec_name == ".got" || sec_name == ".data" || sec_name == ".bss") {
-        // .got/.data/.bss是数据段：需要分配内存 + 可写
-        flags = SHF::ALLOC | SHF::WRITE;
-    } 
-    else if (sec_name == ".rodata") {
-        // .rodata是只读数据段：只需要分配内存
-        flags = static_cast<uint32_t>(SHF::ALLOC);
-    }
-    shdr.flags = flags;
+    shdr.flags = spec.shdr_flags;
 
     // 加到输出节头里面
     result.shdrs.push_back(shdr);
 }
 
+TraceSpan entry_span(trace, "entry resolution");
 if(options.shared == false)
 {
     // 可执行文件检查入口点是否存在，避免无效访问
     // 找到程序入口符号
-    auto entry_it = global_symbols.find(options.entryPoint);
-    if (entry_it == global_symbols.end()) 
+    const SymbolDef* entry = find_global(options.entryPoint);
+    if (!entry) 
     {
         throw runtime_error("Entry point '" + options.entryPoint + "' not found in global symbols");
     }
-    else result.entry = entry_it->second.offset + global_sections[entry_it->second.section].addr; // _start 的最终地址
-    // cout << global_sections[entry_it->second.section].addr << " " << entry_it->second.offset << " " << result.entry << endl;
+    else result.entry = def_addr(*entry); // _start 的最终地址
 }
 else
 {
     result.entry = 0; // 共享库入口为0
 }
 
+entry_span.end();
+
 // 填充最终结果的符号表（关键：解决符号表为空的问题）
-for (const auto& [sym_name, sym] : global_symbols) 
+// 局部符号在各自文件的表里，不导出；按名字排序，保证输出与哈希表的槽位顺序无关
+// 定义在被回收的节里的符号也不导出
+global_symbols.for_each([&](uint32_t, const SymbolDef& def)
 {
-    // 局部符号就不导出来了
-    if (sym.type == SymbolType::LOCAL) continue;
-    result.symbols.push_back(sym);
+    if (!live[def.obj_idx][def.shdr_idx]) return;
+    const auto& m = sec_maps[def.obj_idx][def.shdr_idx];
+    result.symbols.push_back({def.type, output_specs[m.out_id].name, out_offset(def.obj_idx, def.shdr_idx, def.sym->offset), def.sym->size, def.sym->name});
+});
+sort(result.symbols.begin(), result.symbols.end(),
+    [](const Symbol& a, const Symbol& b) { return a.name < b.name; });
+
+// 增量链接：交出布局、符号地址和重定位索引，由调用者保存
+if (layout)
+{
+    layout->objects.clear();
+    for (size_t obj_idx = 0; obj_idx < curr_objs.size(); ++obj_idx)
+    {
+        const auto& obj = *curr_objs[obj_idx];
+        LinkLayout::InputObject in_obj{curr_origins[obj_idx].first, curr_origins[obj_idx].second, {}};
+        for (size_t shdr_idx = 0; shdr_idx < obj.shdrs.size(); ++shdr_idx)
+        {
+            const auto& m = sec_maps[obj_idx][shdr_idx];
+            in_obj.sections.push_back({obj.shdrs[shdr_idx].name, output_specs[m.out_id].name, m.addr, obj.shdrs[shdr_idx].size, m.capacity});
+        }
+        layout->objects.push_back(std::move(in_obj));
+    }
+
+    layout->symbols.clear();
+    global_symbols.for_each([&](uint32_t, const SymbolDef& def)
+    {
+        if (live[def.obj_idx][def.shdr_idx]) layout->symbols[def.sym->name] = {def_addr(def), def.obj_idx};
+    });
+
+    layout->external.clear();
+    for (const auto& sym_name : external_symbols)
+    {
+        // 没有 PLT 表项的外部数据记 0，增量链接遇到对它的 PC32 引用时报错
+        int64_t plt_slot = slot_of(plt_sym, sym_name);
+        layout->external[sym_name] = {plt_slot < 0 ? 0 : global_sections[PLT].addr + plt_slot * 6,
+                                      global_sections[GOT].addr + slot_of(got_sym, sym_name) * 8};
+    }
+
+    layout->fixups.clear();
+    for (auto& fixups : task_fixups)
+    {
+        for (auto& [sym_name, fixup] : fixups) layout->fixups[sym_name].push_back(fixup);
+    }
+    // 全局符号的 GOT 槽位也是一处引用，符号挪动时更新槽位里的地址
+    for (const SymbolDef* def : local_got)
+    {
+        if (def->type == SymbolType::LOCAL) continue;
+        uint64_t slot_addr = global_sections[GOT].addr + local_got_slot.at(def->sym) * 8;
+        layout->fixups[def->sym->name].push_back({def->obj_idx, slot_addr, RelocationType::R_X86_64_64, 0});
+    }
+}
+
+// 链接映射文件（-Map）：每个输出节的地址和大小，下面是组成它的输入节和输入节里定义的符号，
+// 最后按输入文件汇总字节数，用来追查体积和加载时间的变化
+if (!options.map_file.empty())
+{
+    TraceSpan map_span(trace, "write map");
+    ofstream map_out(options.map_file);
+    if (!map_out) throw runtime_error("Cannot open map file: " + options.map_file);
+    // 每行前四列：地址、在输出节里的偏移、大小、对齐；直接写进流里，名字再长也不截断
+    auto columns = [&](uint64_t addr, optional<uint64_t> offset, uint64_t size, optional<uint64_t> align) -> ostream&
+    {
+        map_out << hex << setfill('0') << setw(16) << addr << setfill(' ') << ' ' << setw(8);
+        if (offset) map_out << *offset;
+        else map_out << "";
+        map_out << ' ' << setw(8) << size << dec << ' ' << setw(5);
+        if (align) map_out << *align;
+        else map_out << "";
+        return map_out << ' ';
+    };
+    auto input_name = [&](size_t obj_idx)
+    {
+        auto [input, member] = curr_origins[obj_idx];
+        if (member == LinkLayout::NO_MEMBER) return objects[input]->name;
+        return objects[input]->name + "(" + objects[input]->members[member].name + ")";
+    };
+
+    // 每个输入文件：放进输出的字节数、进了合并块的字节数（去重前）、被回收或折叠掉的字节数
+    struct FileBytes
+    {
+        uint64_t output = 0, merged = 0, discarded = 0;
+    };
+    vector<FileBytes> file_bytes(curr_objs.size());
+    // 按输出节分组的输入节，之后按地址排序
+    vector<vector<pair<size_t, size_t>>> out_inputs(output_specs.size());
+    for (size_t obj_idx = 0; obj_idx < curr_objs.size(); ++obj_idx)
+    {
+        const auto& obj = *curr_objs[obj_idx];
+        for (size_t shdr_idx = 0; shdr_idx < obj.shdrs.size(); ++shdr_idx)
+        {
+            uint64_t size = obj.shdrs[shdr_idx].size;
+            if (!live[obj_idx][shdr_idx] || is_folded(obj_idx, shdr_idx)) file_bytes[obj_idx].discarded += size;
+            else if (is_merged(obj_idx, shdr_idx)) file_bytes[obj_idx].merged += size;
+            else file_bytes[obj_idx].output += size;
+            if (live[obj_idx][shdr_idx]) out_inputs[sec_maps[obj_idx][shdr_idx].out_id].emplace_back(obj_idx, shdr_idx);
+        }
+    }
+
+    map_out << setw(16) << "Address" << ' ' << setw(8) << "Offset" << ' ' << setw(8) << "Size" << ' ' << setw(5) << "Align" << " Out / In / Symbol\n";
+    vector<size_t> out_order;
+    for (size_t id = 0; id < output_specs.size(); ++id)
+    {
+        if (global_sections[id].size > 0) out_order.push_back(id);
+    }
+    sort(out_order.begin(), out_order.end(), [&](size_t a, size_t b) { return global_sections[a].addr < global_sections[b].addr; });
+    for (size_t id : out_order)
+    {
+        columns(global_sections[id].addr, nullopt, global_sections[id].size, max(output_specs[id].align, out_align[id])) << output_specs[id].name << '\n';
+
+        auto& inputs = out_inputs[id];
+        auto in_offset = [&](const pair<size_t, size_t>& in) { return out_offset(in.first, in.second, 0); };
+        stable_sort(inputs.begin(), inputs.end(), [&](const auto& a, const auto& b) { return in_offset(a) < in_offset(b); });
+        for (const auto& [obj_idx, shdr_idx] : inputs)
+        {
+            const auto& obj = *curr_objs[obj_idx];
+            const auto& shdr = obj.shdrs[shdr_idx];
+            uint64_t offset = in_offset({obj_idx, shdr_idx});
+            string what = input_name(obj_idx) + ":(" + shdr.name + ")";
+            if (is_folded(obj_idx, shdr_idx))
+            {
+                const auto& c = canonical[obj_idx][shdr_idx];
+                what += " folded into " + input_name(c.obj_idx) + ":(" + curr_objs[c.obj_idx]->shdrs[c.shdr_idx].name + ")";
+            }
+            else if (is_merged(obj_idx, shdr_idx)) what += " merged";
+            columns(global_sections[id].addr + offset, offset, shdr.size, input_align(obj_idx, shdr_idx)) << "        " << what << '\n';
+
+            vector<const Symbol*> defined;
+            for (const auto& sym : obj.symbols)
+            {
+                if (sym.type != SymbolType::UNDEFINED && sym.section == shdr.name) defined.push_back(&sym);
+            }
+            stable_sort(defined.begin(), defined.end(), [](const Symbol* a, const Symbol* b) { return a->offset < b->offset; });
+            for (const Symbol* sym : defined)
+            {
+                uint64_t sym_offset = out_offset(obj_idx, shdr_idx, sym->offset);
+                columns(global_sections[id].addr + sym_offset, sym_offset, sym->size, nullopt)
+                    << "                " << sym->name << (sym->type == SymbolType::LOCAL ? " (local)" : "") << '\n';
+            }
+        }
+        // 合并块和链接器生成的内容不属于任何输入文件
+        for (const auto& block : merge_blocks)
+        {
+            if (block.out_id != id) continue;
+            columns(global_sections[id].addr + block.out_offset, block.out_offset, block.data.size(), block.align)
+                << "        <merged " << (block.strings ? "strings" : "constants") << ">\n";
+        }
+        if (id == GOT || id == PLT)
+        {
+            columns(global_sections[id].addr, 0, global_sections[id].size, nullopt) << "        <linker synthesized>\n";
+        }
+    }
+
+    map_out << "\nBytes per input file (output: laid out, merged: fed to merge blocks before dedup, discarded: --gc-sections / --icf)\n";
+    auto bytes_row = [&](const auto& output, const auto& merged, const auto& discarded, const string& file)
+    {
+        map_out << setw(10) << output << ' ' << setw(10) << merged << ' ' << setw(10) << discarded << "  " << file << '\n';
+    };
+    bytes_row("Output", "Merged", "Discarded", "File");
+    FileBytes total;
+    for (size_t obj_idx = 0; obj_idx < curr_objs.size(); ++obj_idx)
+    {
+        const auto& bytes = file_bytes[obj_idx];
+        bytes_row(bytes.output, bytes.merged, bytes.discarded, input_name(obj_idx));
+        total.output += bytes.output;
+        total.merged += bytes.merged;
+        total.discarded += bytes.discarded;
+    }
+    bytes_row(total.output, total.merged, total.discarded, "(total)");
 }
 
 return result;
@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+"""
+ld 性能基准：直接生成 FLE 格式的合成输入（不依赖 gcc），测量链接耗时与峰值内存。
+
+用法：
+    python3 tests/bench/bench_ld.py archive --members 10000
+    python3 tests/bench/bench_ld.py group --archives 50 --members 2000
+    python3 tests/bench/bench_ld.py large --objects 100 --funcs 100 --pad 256
+"""
+import argparse
+import json
+import os
+import resource
+import subprocess
+import sys
+import tempfile
+import time
+
+ROOT_DIR = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", ".."))
+LD = os.environ.get("FLE_LD", os.path.join(ROOT_DIR, "ld"))
+
+
+
+def make_obj(funcs, pad=0):
+    """
+    funcs: [(name, binding, callees)]，每个函数占一段 .text，
+    依次调用 callees 中的函数。binding 为 '📤' 或 '🏷️'。
+    pad: 每个函数末尾额外填充的 nop 字节数，用来放大节数据。
+    """
+    lines = []
+    offset = 0
+    for name, binding, callees in funcs:
+        size = 4 + 5 * len(callees) + pad + 2
+        lines.append(f"{binding}: {name} {size} {offset}")
+        lines.append("🔢: 55 48 89 e5")
+        for callee in callees:
+            lines.append("🔢: e8")
+            lines.append(f"❓: .rel({callee} - 4)")
+        for i in range(0, pad, 16):
+            lines.append("🔢: " + " ".join(["90"] * min(16, pad - i)))
+        lines.append("🔢: 5d c3")
+        offset += size
+    return {
+        "type": ".obj",
+        "shdrs": [
+            {"name": ".text", "type": 1, "flags": 5, "addr": 0, "offset": 0, "size": offset}
+        ],
+        ".text": lines,
+    }
+
+
+def write_json(path, obj):
+    with open(path, "w") as f:
+        json.dump(obj, f, ensure_ascii=False)
+
+
+def write_archive(path, members):
+    write_json(path, {"type": ".ar", "name": os.path.basename(path), "members": members})
+
+
+def gen_archive(work_dir, n_members):
+    """
+    一个 n_members 个成员的静态库：成员 i 定义 f_i 并调用 f_{i+1}，
+    主程序只引用 f_0，链接器需要沿着依赖链把所有成员拉进来。
+    另有同样数量的无关成员，不应被拉入。
+    """
+    members = []
+    for i in range(n_members):
+        callees = [f"f_{i + 1}"] if i + 1 < n_members else []
+        member = make_obj([(f"f_{i}", "📤", callees)])
+        member["name"] = f"m{i}.fo"
+        members.append(member)
+    for i in range(n_members):
+        member = make_obj([(f"unused_{i}", "📤", [])])
+        member["name"] = f"u{i}.fo"
+        members.append(member)
+    write_archive(os.path.join(work_dir, "libbig.fa"), members)
+    write_json(os.path.join(work_dir, "main.fo"), make_obj([("_start", "📤", ["f_0"])]))
+    return ["main.fo", "libbig.fa"]
+
+
+def gen_group(work_dir, n_archives, n_members):
+    """
+    互相依赖的一组静态库：链上第 i 个函数 c_i 调用 c_{i+1}，
+    c_i 放在第 (-i mod n_archives) 个库里，所以每一步都回到命令行上更靠前的库，
+    整条链要在组内绕 n_members 圈。每个库另有同样数量的无关成员。
+    """
+    length = n_archives * n_members
+    libs = [[] for _ in range(n_archives)]
+    for i in range(length):
+        callees = [f"c_{i + 1}"] if i + 1 < length else []
+        member = make_obj([(f"c_{i}", "📤", callees)])
+        member["name"] = f"c{i}.fo"
+        libs[-i % n_archives].append(member)
+    inputs = ["main.fo", "--strict-archive-order", "--start-group"]
+    for k, members in enumerate(libs):
+        for j in range(n_members):
+            member = make_obj([(f"unused_{k}_{j}", "📤", [])])
+            member["name"] = f"u{k}_{j}.fo"
+            members.append(member)
+        write_archive(os.path.join(work_dir, f"lib{k}.fa"), members)
+        inputs.append(f"lib{k}.fa")
+    inputs.append("--end-group")
+    write_json(os.path.join(work_dir, "main.fo"), make_obj([("_start", "📤", ["c_0"])]))
+    return inputs
+
+
+def gen_large(work_dir, n_objects, n_funcs, pad):
+    """
+    大链接：n_objects 个目标文件，每个含 n_funcs 个函数，
+    每个函数调用下一个目标文件里的同号函数，并填充 pad 字节。
+    """
+    inputs = []
+    for i in range(n_objects):
+        funcs = []
+        for j in range(n_funcs):
+            callees = [f"g_{(i + 1) % n_objects}_{j}", f"g_{i}_{(j + 1) % n_funcs}"]
+            funcs.append((f"g_{i}_{j}", "📤", callees))
+        if i == 0:
+            funcs.append(("_start", "📤", ["g_0_0"]))
+        write_json(os.path.join(work_dir, f"o{i}.fo"), make_obj(funcs, pad))
+        inputs.append(f"o{i}.fo")
+    return inputs
+
+
+def run_ld(work_dir, inputs, extra_args):
+    cmd = [LD] + inputs + ["-o", "program"] + extra_args
+    before = resource.getrusage(resource.RUSAGE_CHILDREN)
+    start = time.perf_counter()
+    proc = subprocess.run(cmd, cwd=work_dir, capture_output=True, text=True)
+    elapsed = time.perf_counter() - start
+    after = resource.getrusage(resource.RUSAGE_CHILDREN)
+    if proc.returncode != 0:
+        sys.stderr.write(proc.stderr)
+        sys.exit(f"ld failed: {' '.join(cmd)}")
+    # ru_maxrss 是所有已回收子进程中的最大值，只在它变大时才可信
+    peak_kb = after.ru_maxrss if after.ru_maxrss > before.ru_maxrss else None
+    return elapsed, peak_kb
+
+
+SCENARIOS = {
+    "archive": lambda args, work_dir: gen_archive(work_dir, args.members),
+    "group": lambda args, work_dir: gen_group(work_dir, args.archives, args.members),
+    "large": lambda args, work_dir: gen_large(work_dir, args.objects, args.funcs, args.pad),
+}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark the FLE linker")
+    parser.add_argument("scenario", choices=sorted(SCENARIOS))
+    parser.add_argument("--members", type=int, default=10000, help="archive members (per archive for group)")
+    parser.add_argument("--archives", type=int, default=50, help="archives in the group")
+    parser.add_argument("--objects", type=int, default=100, help="objects in the large link")
+    parser.add_argument("--funcs", type=int, default=100, help="functions per object")
+    parser.add_argument("--pad", type=int, default=256, help="filler bytes per function")
+    parser.add_argument("--repeat", type=int, default=3, help="number of timed runs")
+    parser.add_argument("--ld-args", default="", help="extra arguments passed to ld")
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory(prefix="fle-bench-") as work_dir:
+        inputs = SCENARIOS[args.scenario](args, work_dir)
+        extra_args = args.ld_args.split()
+        times = []
+        peak = None
+        for _ in range(args.repeat):
+            elapsed, peak_kb = run_ld(work_dir, inputs, extra_args)
+            times.append(elapsed)
+            peak = peak_kb or peak
+        print(f"scenario : {args.scenario}")
+        print(f"best     : {min(times):.3f}s")
+        print(f"median   : {sorted(times)[len(times) // 2]:.3f}s")
+        if peak is not None:
+            print(f"peak RSS : {peak / 1024:.1f} MiB")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,112 @@
+// 重定位批量引擎的微基准：每种重定位类型分别对比
+//   naive  —— 逐条处理，8/4 次移位单字节写入（FLE_ld 原来的做法）
+//   batch  —— RelocBatch + apply_reloc_batch
+// 用法：make bench && ./tests/bench/reloc_bench [relocs_per_type]
+
+#include "reloc_batch.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct NaiveReloc {
+    RelocationType type;
+    size_t offset;
+    uint32_t symbol;
+    int64_t addend;
+};
+
+void apply_naive(const std::vector<NaiveReloc>& relocs, const std::vector<uint64_t>& sym_addr,
+    uint64_t base_addr, std::vector<uint8_t>& out)
+{
+    for (const auto& reloc : relocs) {
+        int64_t S = sym_addr[reloc.symbol];
+        int64_t A = reloc.addend;
+        int64_t P = base_addr + reloc.offset;
+        if (reloc.type == RelocationType::R_X86_64_64) {
+            uint64_t v = S + A;
+            for (int i = 0; i < 8; ++i) {
+                out[reloc.offset + i] = (v >> (8 * i)) & 0xFF;
+            }
+        } else if (reloc.type == RelocationType::R_X86_64_32 || reloc.type == RelocationType::R_X86_64_32S) {
+            uint32_t v = S + A;
+            for (int i = 0; i < 4; ++i) {
+                out[reloc.offset + i] = (v >> (8 * i)) & 0xFF;
+            }
+        } else {
+            int32_t v = S + A - P;
+            for (int i = 0; i < 4; ++i) {
+                out[reloc.offset + i] = (v >> (8 * i)) & 0xFF;
+            }
+        }
+    }
+}
+
+template <typename F>
+double best_of(int runs, F&& f)
+{
+    double best = 1e30;
+    for (int r = 0; r < runs; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    size_t n = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const uint64_t base_addr = 0x400000;
+    const size_t num_symbols = 4096;
+
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> sym_addr(num_symbols);
+    for (auto& addr : sym_addr) {
+        addr = base_addr + rng() % 0x100000;
+    }
+
+    const std::pair<RelocationType, const char*> types[] = {
+        { RelocationType::R_X86_64_32, "R_X86_64_32" },
+        { RelocationType::R_X86_64_PC32, "R_X86_64_PC32" },
+        { RelocationType::R_X86_64_64, "R_X86_64_64" },
+        { RelocationType::R_X86_64_32S, "R_X86_64_32S" },
+        { RelocationType::R_X86_64_GOTPCREL, "R_X86_64_GOTPCREL" },
+    };
+
+    std::printf("%-18s %10s %12s %12s %8s\n", "type", "relocs", "naive(ms)", "batch(ms)", "speedup");
+    for (const auto& [type, name] : types) {
+        size_t width = type == RelocationType::R_X86_64_64 ? 8 : 4;
+        std::vector<uint8_t> out_naive(n * width), out_batch(n * width);
+
+        // 和真实的代码段一样，每个重定位字段紧挨着，偏移按顺序递增
+        std::vector<NaiveReloc> naive;
+        RelocBatch batch;
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t sym = rng() % num_symbols;
+            int64_t addend = -4 + static_cast<int64_t>(rng() % 16);
+            naive.push_back({ type, i * width, sym, addend });
+            batch.push(i * width, sym, addend);
+        }
+
+        std::vector<uint64_t> scratch;
+        double t_naive = best_of(5, [&] { apply_naive(naive, sym_addr, base_addr, out_naive); });
+        double t_batch = best_of(5, [&] {
+            apply_reloc_batch(type, batch, sym_addr.data(), base_addr, out_batch.data(), scratch);
+        });
+
+        if (out_naive != out_batch) {
+            std::fprintf(stderr, "%s: batch result differs from naive result\n", name);
+            return 1;
+        }
+        std::printf("%-18s %10zu %12.3f %12.3f %7.2fx\n", name, n, t_naive, t_batch, t_naive / t_batch);
+    }
+    return 0;
+}
@@ -0,0 +1,202 @@
+// 符号表的微基准：模拟重定位阶段按名字查找符号，对比
+//   map    —— std::map<string, Symbol>，局部符号以 "文件名::符号名" 为键（FLE_ld 原来的做法）
+//   interned —— StringInterner + IdHashMap，局部符号按文件分表
+//   sharded  —— ShardedStringInterner + ShardedIdHashMap，按名字哈希分片后在线程池上并行构建
+// 用法：make bench && ./tests/bench/symtab_bench [relocs] [objects] [symbols_per_object] [threads]
+
+#include "fle.hpp"
+#include "symbol_table.hpp"
+#include "thread_pool.hpp"
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct InputReloc {
+    uint32_t obj; // 所在目标文件
+    std::string symbol;
+};
+
+struct Def {
+    uint64_t addr;
+};
+
+template <typename F>
+double time_ms(F&& f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    size_t n = argc > 1 ? std::stoul(argv[1]) : 4000000;
+    size_t num_objs = argc > 2 ? std::stoul(argv[2]) : 1000;
+    size_t syms_per_obj = argc > 3 ? std::stoul(argv[3]) : 100;
+    size_t threads = argc > 4 ? std::stoul(argv[4]) : std::thread::hardware_concurrency();
+
+    // 每个文件定义 syms_per_obj 个全局符号和 syms_per_obj / 4 个局部符号，
+    // 局部符号的名字在各个文件间重复（static 函数常见的情况）
+    std::vector<std::string> obj_names;
+    std::vector<std::vector<Symbol>> objs(num_objs);
+    std::mt19937_64 rng(42);
+    for (size_t i = 0; i < num_objs; ++i) {
+        obj_names.push_back("obj" + std::to_string(i) + ".fo");
+        for (size_t j = 0; j < syms_per_obj; ++j) {
+            objs[i].push_back({ SymbolType::GLOBAL, ".text", j * 16, 16, "func_" + std::to_string(i) + "_" + std::to_string(j) });
+        }
+        for (size_t j = 0; j < syms_per_obj / 4; ++j) {
+            objs[i].push_back({ SymbolType::LOCAL, ".text", j * 8, 8, "helper_" + std::to_string(j) });
+        }
+    }
+
+    // 重定位：3/4 引用别的文件的全局符号，1/4 引用本文件的局部符号
+    std::vector<InputReloc> relocs;
+    relocs.reserve(n);
+    for (size_t k = 0; k < n; ++k) {
+        uint32_t obj = rng() % num_objs;
+        if (rng() % 4 == 0 && syms_per_obj >= 4) {
+            relocs.push_back({ obj, "helper_" + std::to_string(rng() % (syms_per_obj / 4)) });
+        } else {
+            relocs.push_back({ obj, "func_" + std::to_string(rng() % num_objs) + "_" + std::to_string(rng() % syms_per_obj) });
+        }
+    }
+
+    // ---- std::map + 拼接名字 ----
+    uint64_t sum_map = 0;
+    std::map<std::string, Def> map_table;
+    double build_map = time_ms([&] {
+        for (size_t i = 0; i < num_objs; ++i) {
+            for (const auto& sym : objs[i]) {
+                std::string key = sym.type == SymbolType::LOCAL ? obj_names[i] + "::" + sym.name : sym.name;
+                map_table.emplace(key, Def { i * 0x1000 + sym.offset });
+            }
+        }
+    });
+    double lookup_map = time_ms([&] {
+        for (const auto& reloc : relocs) {
+            std::string key = obj_names[reloc.obj] + "::" + reloc.symbol;
+            if (!map_table.count(key)) {
+                key = reloc.symbol;
+            }
+            sum_map += map_table.at(key).addr;
+        }
+    });
+
+    // ---- 名字驻留 + 开放寻址 ----
+    uint64_t sum_interned = 0;
+    StringInterner names;
+    IdHashMap<Def> globals;
+    std::vector<IdHashMap<Def>> locals(num_objs);
+    double build_interned = time_ms([&] {
+        for (size_t i = 0; i < num_objs; ++i) {
+            for (const auto& sym : objs[i]) {
+                uint32_t id = names.intern(sym.name);
+                auto& table = sym.type == SymbolType::LOCAL ? locals[i] : globals;
+                auto [slot, inserted] = table.try_emplace(id);
+                if (inserted) {
+                    *slot = Def { i * 0x1000 + sym.offset };
+                }
+            }
+        }
+    });
+    double lookup_interned = time_ms([&] {
+        for (const auto& reloc : relocs) {
+            uint32_t id = names.find(reloc.symbol);
+            const Def* def = locals[reloc.obj].find(id);
+            if (!def) {
+                def = globals.find(id);
+            }
+            sum_interned += def->addr;
+        }
+    });
+
+    // ---- 按名字哈希分片，并行构建 ----
+    // 与 FLE_ld 一样：先按文件算哈希并把符号按分片分组，再每个分片一个任务按文件顺序插入，
+    // 最后按文件并行填局部符号表
+    uint64_t sum_sharded = 0;
+    ThreadPool pool(threads);
+    ShardedStringInterner sharded_names;
+    ShardedIdHashMap<Def> sharded_globals;
+    std::vector<IdHashMap<Def>> sharded_locals(num_objs);
+    double build_sharded = time_ms([&] {
+        std::vector<std::vector<uint64_t>> hashes(num_objs);
+        std::vector<std::vector<uint32_t>> ids(num_objs);
+        std::vector<std::vector<std::vector<uint32_t>>> by_shard(num_objs);
+        parallel_for(&pool, num_objs, [&](size_t i) {
+            by_shard[i].resize(SYMBOL_SHARDS);
+            ids[i].resize(objs[i].size());
+            for (const auto& sym : objs[i]) {
+                hashes[i].push_back(hash_name(sym.name));
+                by_shard[i][shard_of(hashes[i].back())].push_back(static_cast<uint32_t>(hashes[i].size() - 1));
+            }
+        });
+        parallel_for(&pool, SYMBOL_SHARDS, [&](size_t shard) {
+            for (size_t i = 0; i < num_objs; ++i) {
+                for (uint32_t k : by_shard[i][shard]) {
+                    const auto& sym = objs[i][k];
+                    ids[i][k] = sharded_names.intern(sym.name, hashes[i][k]);
+                    if (sym.type == SymbolType::LOCAL) {
+                        continue;
+                    }
+                    auto [slot, inserted] = sharded_globals.shard(shard).try_emplace(ids[i][k]);
+                    if (inserted) {
+                        *slot = Def { i * 0x1000 + sym.offset };
+                    }
+                }
+            }
+        });
+        parallel_for(&pool, num_objs, [&](size_t i) {
+            for (size_t k = 0; k < objs[i].size(); ++k) {
+                if (objs[i][k].type != SymbolType::LOCAL) {
+                    continue;
+                }
+                auto [slot, inserted] = sharded_locals[i].try_emplace(ids[i][k]);
+                if (inserted) {
+                    *slot = Def { i * 0x1000 + objs[i][k].offset };
+                }
+            }
+        });
+    });
+    double lookup_sharded = time_ms([&] {
+        for (const auto& reloc : relocs) {
+            uint32_t id = sharded_names.find(reloc.symbol);
+            const Def* def = sharded_locals[reloc.obj].find(id);
+            if (!def) {
+                def = sharded_globals.find(id);
+            }
+            sum_sharded += def->addr;
+        }
+    });
+
+    if (sum_map != sum_interned) {
+        std::fprintf(stderr, "interned lookup result differs from map lookup result\n");
+        return 1;
+    }
+    if (sum_sharded != sum_interned) {
+        std::fprintf(stderr, "sharded lookup result differs from interned lookup result\n");
+        return 1;
+    }
+
+    size_t num_syms = 0;
+    for (const auto& obj : objs) {
+        num_syms += obj.size();
+    }
+    std::printf("%zu symbols in %zu objects, %zu relocations\n", num_syms, num_objs, n);
+    std::printf("%-10s %12s %12s\n", "", "build(ms)", "lookup(ms)");
+    std::printf("%-10s %12.3f %12.3f\n", "map", build_map, lookup_map);
+    std::printf("%-10s %12.3f %12.3f\n", "interned", build_interned, lookup_interned);
+    std::printf("%-10s %12.3f %12.3f\n", "sharded", build_sharded, lookup_sharded);
+    std::printf("lookup speedup: %.2fx\n", lookup_map / lookup_interned);
+    std::printf("sharded build speedup (%zu threads): %.2fx\n", pool.size(), build_interned / build_sharded);
+    return 0;
+}
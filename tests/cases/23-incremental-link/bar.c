@@ -0,0 +1,14 @@
+#include "minilibc.h"
+
+int counter = 7;
+
+static int twice(int x)
+{
+    return x * 2;
+}
+
+int describe(int v)
+{
+    printf("describe %d\n", v);
+    return twice(v) + counter;
+}
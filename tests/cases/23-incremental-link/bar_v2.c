@@ -0,0 +1,16 @@
+#include "minilibc.h"
+
+// 比 bar.c 稍大：describe 和 counter 都往后挪了，但还在预留空间之内
+static int bias = 3;
+int counter = 7;
+
+static int twice(int x)
+{
+    return x * 2 + bias;
+}
+
+int describe(int v)
+{
+    printf("describe v2 %d\n", v);
+    return twice(v) + counter;
+}
@@ -0,0 +1,17 @@
+#include "minilibc.h"
+
+// 多了一张大表，.data 放不进原来的槽位，只能完整链接
+static int table[64] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+int counter = 7;
+
+static int twice(int x)
+{
+    table[x % 8] += x;
+    return x * 2 + table[x % 8];
+}
+
+int describe(int v)
+{
+    printf("describe v3 %d\n", v);
+    return twice(v) + counter;
+}
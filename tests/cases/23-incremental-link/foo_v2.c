@@ -0,0 +1,5 @@
+// 与 foo.c 的机器码一样长，只改了常数
+int scale(int x)
+{
+    return x * 3 + 5;
+}
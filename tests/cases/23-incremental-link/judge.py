@@ -0,0 +1,43 @@
+#!/usr/bin/env python3
+import json
+import os
+import sys
+
+
+def judge():
+    try:
+        input_data = json.load(sys.stdin)
+        build_dir = os.path.join(input_data["test_dir"], "build")
+        incremental_path = os.path.join(build_dir, "program")
+        clean_path = os.path.join(build_dir, "reference")
+
+        try:
+            with open(incremental_path, "rb") as f:
+                incremental = f.read()
+            with open(clean_path, "rb") as f:
+                clean = f.read()
+        except Exception as e:
+            print(json.dumps({"success": False, "message": f"Failed to read outputs: {str(e)}"}))
+            return
+
+        # foo.c 改动前后大小一样，原地修补的结果必须与同样选项下的完整链接逐字节相同
+        if incremental != clean:
+            inc_lines = incremental.decode("utf-8", "replace").splitlines()
+            clean_lines = clean.decode("utf-8", "replace").splitlines()
+            for i, (a, b) in enumerate(zip(inc_lines, clean_lines)):
+                if a != b:
+                    message = f"Line {i + 1} differs: incremental {a.strip()!r}, clean {b.strip()!r}"
+                    break
+            else:
+                message = f"Outputs differ in length ({len(inc_lines)} vs {len(clean_lines)} lines)"
+            print(json.dumps({"success": False, "message": message}))
+            return
+
+        print(json.dumps({"success": True, "message": "Incremental output matches the clean link."}))
+
+    except Exception as e:
+        print(json.dumps({"success": False, "message": f"Judge error: {str(e)}"}))
+
+
+if __name__ == "__main__":
+    judge()
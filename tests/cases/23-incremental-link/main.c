@@ -0,0 +1,15 @@
+#include "minilibc.h"
+
+// 由 foo.c 和 bar.c 提供，测试时会换成新版本重新编译
+extern int scale(int x);
+extern int describe(int v);
+extern int counter;
+
+int main(void)
+{
+    int a = scale(4);
+    int b = describe(a);
+    counter += b;
+    printf("a=%d b=%d counter=%d\n", a, b, counter);
+    return 0;
+}
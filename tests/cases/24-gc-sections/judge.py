@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+import json
+import os
+import sys
+
+
+def load_fle(path):
+    with open(path, "r") as f:
+        return json.load(f)
+
+
+def segment_sizes(fle):
+    return {phdr["name"]: phdr["size"] for phdr in fle.get("phdrs", [])}
+
+
+def symbol_names(fle):
+    names = set()
+    for key, lines in fle.items():
+        if not isinstance(lines, list):
+            continue
+        for line in lines:
+            if isinstance(line, str) and line.startswith(("📤:", "📎:", "🏷️:")):
+                names.add(line.split(":", 1)[1].split()[0])
+    return names
+
+
+def judge():
+    try:
+        input_data = json.load(sys.stdin)
+        build_dir = os.path.join(input_data["test_dir"], "build")
+        try:
+            program = load_fle(os.path.join(build_dir, "program"))
+            full = load_fle(os.path.join(build_dir, "full"))
+        except Exception as e:
+            print(json.dumps({"success": False, "message": f"Failed to load programs: {str(e)}"}))
+            return
+
+        names = symbol_names(program)
+        for name in ("used_func", "used_table", "main"):
+            if name not in names:
+                print(json.dumps({"success": False, "message": f"Live symbol '{name}' is missing"}))
+                return
+        for name in ("unused_func", "unused_helper", "unused_table", "unused_counter"):
+            if name in names:
+                print(json.dumps({"success": False, "message": f"Dead symbol '{name}' was not removed"}))
+                return
+
+        gc_sizes = segment_sizes(program)
+        full_sizes = segment_sizes(full)
+        if gc_sizes.get(".text", 0) >= full_sizes.get(".text", 0):
+            print(json.dumps({"success": False, "message": f".text did not shrink: {gc_sizes.get('.text')} vs {full_sizes.get('.text')}"}))
+            return
+        if gc_sizes.get(".data", 0) >= full_sizes.get(".data", 0):
+            print(json.dumps({"success": False, "message": f".data did not shrink: {gc_sizes.get('.data')} vs {full_sizes.get('.data')}"}))
+            return
+        if ".bss" in gc_sizes:
+            print(json.dumps({"success": False, "message": "Unused .bss was kept"}))
+            return
+
+        print(json.dumps({"success": True, "message": f".text {full_sizes['.text']} -> {gc_sizes['.text']} bytes, .data {full_sizes['.data']} -> {gc_sizes['.data']} bytes"}))
+
+    except Exception as e:
+        print(json.dumps({"success": False, "message": f"Judge error: {str(e)}"}))
+
+
+if __name__ == "__main__":
+    judge()
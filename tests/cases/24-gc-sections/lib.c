@@ -0,0 +1,27 @@
+// 用 -ffunction-sections -fdata-sections 编译，每个函数和变量各占一个节
+
+int used_table[4] = { 10, 20, 30, 40 };
+int unused_table[256] = { 1, 2, 3 };
+int unused_counter;
+
+static int helper(int x)
+{
+    return x * 7;
+}
+
+int used_func(int x)
+{
+    return helper(x) + 1;
+}
+
+// 只被 unused_func 调用，会跟着一起被回收
+int unused_helper(int x)
+{
+    unused_counter += x;
+    return unused_table[x & 255];
+}
+
+int unused_func(int x)
+{
+    return unused_helper(x) * 2;
+}
@@ -0,0 +1,10 @@
+#include "minilibc.h"
+
+extern int used_func(int x);
+extern int used_table[4];
+
+int main(void)
+{
+    printf("%d %d\n", used_func(3), used_table[2]);
+    return 0;
+}
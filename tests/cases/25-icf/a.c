@@ -0,0 +1,25 @@
+// 用 -ffunction-sections 编译，每个函数各占一个节
+
+__attribute__((noinline)) int square_a(int x)
+{
+    return x * x + 1;
+}
+
+// ping_a 和 pong_a 互相调用，除了调用目标外完全相同
+__attribute__((noinline)) int pong_a(int n);
+
+__attribute__((noinline)) int ping_a(int n)
+{
+    return n <= 0 ? 0 : pong_a(n - 1) + 2;
+}
+
+__attribute__((noinline)) int pong_a(int n)
+{
+    return n <= 0 ? 0 : ping_a(n - 1) + 2;
+}
+
+// 地址会被 main 拿去比较
+__attribute__((noinline)) int triple_a(int x)
+{
+    return x * 3;
+}
@@ -0,0 +1,29 @@
+// 与 a.c 里的函数逐字节相同，只是名字不同
+
+__attribute__((noinline)) int square_b(int x)
+{
+    return x * x + 1;
+}
+
+__attribute__((noinline)) int pong_b(int n);
+
+__attribute__((noinline)) int ping_b(int n)
+{
+    return n <= 0 ? 0 : pong_b(n - 1) + 2;
+}
+
+__attribute__((noinline)) int pong_b(int n)
+{
+    return n <= 0 ? 0 : ping_b(n - 1) + 2;
+}
+
+__attribute__((noinline)) int triple_b(int x)
+{
+    return x * 3;
+}
+
+// 和 square_b 只差一个常数，不能折叠
+__attribute__((noinline)) int not_square(int x)
+{
+    return x * x + 2;
+}
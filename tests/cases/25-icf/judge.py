@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+import json
+import os
+import sys
+
+
+def load_fle(path):
+    with open(path, "r") as f:
+        return json.load(f)
+
+
+def segment_sizes(fle):
+    return {phdr["name"]: phdr["size"] for phdr in fle.get("phdrs", [])}
+
+
+def symbol_offsets(fle):
+    # 📤: 名字 大小 节内偏移
+    offsets = {}
+    for key, lines in fle.items():
+        if not isinstance(lines, list):
+            continue
+        for line in lines:
+            if isinstance(line, str) and line.startswith("📤:"):
+                parts = line.split(":", 1)[1].split()
+                offsets[parts[0]] = (key, int(parts[2]))
+    return offsets
+
+
+def check(fle, same, different):
+    offsets = symbol_offsets(fle)
+    for group in same:
+        places = {offsets.get(name) for name in group}
+        if None in places or len(places) != 1:
+            return f"{', '.join(group)} should share one address"
+    for group in different:
+        places = {offsets.get(name) for name in group}
+        if None in places or len(places) != len(group):
+            return f"{', '.join(group)} should have distinct addresses"
+    return None
+
+
+def judge():
+    try:
+        input_data = json.load(sys.stdin)
+        build_dir = os.path.join(input_data["test_dir"], "build")
+        try:
+            full = load_fle(os.path.join(build_dir, "full"))
+            safe = load_fle(os.path.join(build_dir, "safe"))
+            all_ = load_fle(os.path.join(build_dir, "all"))
+        except Exception as e:
+            print(json.dumps({"success": False, "message": f"Failed to load programs: {str(e)}"}))
+            return
+
+        cycle = ["ping_a", "pong_a", "ping_b", "pong_b"]
+        error = check(full, [], [["square_a", "square_b", "not_square"], cycle])
+        if error is None:
+            error = check(safe, [["square_a", "square_b"], cycle], [["triple_a", "triple_b"], ["square_a", "not_square"]])
+        if error is None:
+            error = check(all_, [["square_a", "square_b"], cycle, ["triple_a", "triple_b"]], [["square_a", "not_square"]])
+        if error is not None:
+            print(json.dumps({"success": False, "message": error}))
+            return
+
+        full_text = segment_sizes(full).get(".text", 0)
+        safe_text = segment_sizes(safe).get(".text", 0)
+        all_text = segment_sizes(all_).get(".text", 0)
+        if not full_text > safe_text > all_text:
+            print(json.dumps({"success": False, "message": f".text sizes should shrink: {full_text}, {safe_text}, {all_text}"}))
+            return
+
+        print(json.dumps({"success": True, "message": f".text {full_text} -> {safe_text} (safe) -> {all_text} (all) bytes"}))
+
+    except Exception as e:
+        print(json.dumps({"success": False, "message": f"Judge error: {str(e)}"}))
+
+
+if __name__ == "__main__":
+    judge()
@@ -0,0 +1,20 @@
+#include "minilibc.h"
+
+extern int square_a(int x);
+extern int square_b(int x);
+extern int not_square(int x);
+extern int ping_a(int n);
+extern int ping_b(int n);
+extern int triple_a(int x);
+extern int triple_b(int x);
+
+int main(void)
+{
+    // volatile 让比较留到运行时，编译器会假设不同函数的地址一定不同
+    int (*volatile fa)(int) = triple_a;
+    int (*volatile fb)(int) = triple_b;
+    printf("%d %d %d\n", square_a(3), square_b(4), not_square(5));
+    printf("%d %d\n", ping_a(5), ping_b(6));
+    printf("%d %d %d\n", fa(2), fb(3), fa == fb);
+    return 0;
+}
@@ -0,0 +1,11 @@
+#include "minilibc.h"
+
+void report_a(int value)
+{
+    printf("value = %d\n", value);
+}
+
+const char* status_a(int ok)
+{
+    return ok ? "passed" : "check failed";
+}
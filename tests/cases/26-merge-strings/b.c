@@ -0,0 +1,13 @@
+#include "minilibc.h"
+
+// 用 -fno-PIE 编译，字符串通过 .abs(.rodata.str1.1 + 偏移) 引用
+void report_b(int value)
+{
+    printf("value = %d\n", value);
+}
+
+const char* status_b(int ok)
+{
+    // "failed" 是 a.c 里 "check failed" 的后缀，-O2 时共用存储
+    return ok ? "passed" : "failed";
+}
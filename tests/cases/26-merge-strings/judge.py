@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+import json
+import os
+import sys
+
+
+def load_fle(path):
+    with open(path, "r") as f:
+        return json.load(f)
+
+
+def section_bytes(fle, name):
+    data = bytearray()
+    for line in fle.get(name, []):
+        if isinstance(line, str) and line.startswith("🔢:"):
+            data.extend(bytes.fromhex(line.split(":", 1)[1]))
+    return bytes(data)
+
+
+def judge():
+    try:
+        input_data = json.load(sys.stdin)
+        build_dir = os.path.join(input_data["test_dir"], "build")
+        try:
+            unmerged = section_bytes(load_fle(os.path.join(build_dir, "unmerged")), ".rodata")
+            merged = section_bytes(load_fle(os.path.join(build_dir, "program")), ".rodata")
+            tail = section_bytes(load_fle(os.path.join(build_dir, "tail")), ".rodata")
+        except Exception as e:
+            print(json.dumps({"success": False, "message": f"Failed to load programs: {str(e)}"}))
+            return
+
+        # main.c、a.c、b.c 里各有一份 "value = %d\n"，a.c 和 b.c 里各有一份 "passed"
+        for s in (b"value = %d\n\0", b"passed\0"):
+            if unmerged.count(s) < 2:
+                print(json.dumps({"success": False, "message": f"-O0 should keep every copy of {s!r}"}))
+                return
+            for name, data in (("default", merged), ("-O2", tail)):
+                if data.count(s) != 1:
+                    print(json.dumps({"success": False, "message": f"{name}: {s!r} appears {data.count(s)} times"}))
+                    return
+
+        # -O2 时 "failed" 放在 "check failed" 的末尾
+        if tail.count(b"failed\0") != 1 or merged.count(b"failed\0") != 2:
+            print(json.dumps({"success": False, "message": "\"failed\" should be tail-merged only at -O2"}))
+            return
+
+        if not len(unmerged) > len(merged) > len(tail):
+            print(json.dumps({"success": False, "message": f".rodata sizes should shrink: {len(unmerged)}, {len(merged)}, {len(tail)}"}))
+            return
+
+        print(json.dumps({"success": True, "message": f".rodata {len(unmerged)} -> {len(merged)} -> {len(tail)} (-O2) bytes"}))
+
+    except Exception as e:
+        print(json.dumps({"success": False, "message": f"Judge error: {str(e)}"}))
+
+
+if __name__ == "__main__":
+    judge()
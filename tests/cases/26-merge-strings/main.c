@@ -0,0 +1,17 @@
+#include "minilibc.h"
+
+extern void report_a(int value);
+extern void report_b(int value);
+extern const char* status_a(int ok);
+extern const char* status_b(int ok);
+
+int main(void)
+{
+    report_a(1);
+    report_b(2);
+    printf("value = %d\n", 3);
+    // 不同文件里相同的字符串合并后应该是同一个地址
+    print(status_a(1), " ", status_b(0), " ", status_a(0), "\n", (const char*)0);
+    printf("%d\n", status_a(1) == status_b(1));
+    return 0;
+}
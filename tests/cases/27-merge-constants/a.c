@@ -0,0 +1,12 @@
+// 两个文件用到相同的浮点常量，gcc 把它们放进 .rodata.cst8 / .rodata.cst16
+
+int scale_a(int x)
+{
+    return (int)(x * 2.5 + 0.75);
+}
+
+// fabs 用 andpd 和 16 字节的掩码常量实现，掩码必须 16 字节对齐
+int distance_a(int x, int y)
+{
+    return (int)__builtin_fabs((double)x - y * 1.25);
+}
@@ -0,0 +1,15 @@
+int scale_b(int x)
+{
+    return (int)(x * 2.5 + 0.75);
+}
+
+int distance_b(int x, int y)
+{
+    return (int)__builtin_fabs((double)y - x * 1.25);
+}
+
+// 只有这里用到的常量，合并后也要保留
+int offset_b(int x)
+{
+    return (int)(x * 0.5 + 100.0);
+}
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+import json
+import os
+import struct
+import sys
+
+
+def load_fle(path):
+    with open(path, "r") as f:
+        return json.load(f)
+
+
+def section_bytes(fle, name):
+    data = bytearray()
+    for line in fle.get(name, []):
+        if isinstance(line, str) and line.startswith("🔢:"):
+            data.extend(bytes.fromhex(line.split(":", 1)[1]))
+    return bytes(data)
+
+
+def section_addr(fle, name):
+    for phdr in fle.get("phdrs", []):
+        if phdr["name"] == name:
+            return phdr["vaddr"]
+    return None
+
+
+def judge():
+    try:
+        input_data = json.load(sys.stdin)
+        build_dir = os.path.join(input_data["test_dir"], "build")
+        try:
+            unmerged_fle = load_fle(os.path.join(build_dir, "unmerged"))
+            program_fle = load_fle(os.path.join(build_dir, "program"))
+        except Exception as e:
+            print(json.dumps({"success": False, "message": f"Failed to load programs: {str(e)}"}))
+            return
+        unmerged = section_bytes(unmerged_fle, ".rodata")
+        merged = section_bytes(program_fle, ".rodata")
+        base = section_addr(program_fle, ".rodata")
+
+        # a.c 和 b.c 各有一份的常量，合并后只剩一份，而且按自身大小对齐
+        for value in (2.5, 0.75, 1.25):
+            pattern = struct.pack("<d", value)
+            if unmerged.count(pattern) < 2:
+                print(json.dumps({"success": False, "message": f"-O0 should keep both copies of {value}"}))
+                return
+            if merged.count(pattern) != 1:
+                print(json.dumps({"success": False, "message": f"{value} appears {merged.count(pattern)} times after merging"}))
+                return
+            if (base + merged.find(pattern)) % 8 != 0:
+                print(json.dumps({"success": False, "message": f"{value} is not 8-byte aligned"}))
+                return
+        if merged.count(struct.pack("<d", 0.5)) != 1 or merged.count(struct.pack("<d", 100.0)) != 1:
+            print(json.dumps({"success": False, "message": "Constants used by only one object were dropped"}))
+            return
+
+        # fabs 的掩码：16 字节，andpd 要求 16 字节对齐
+        mask = struct.pack("<QQ", 0x7FFFFFFFFFFFFFFF, 0)
+        if merged.count(mask) != 1:
+            print(json.dumps({"success": False, "message": f"fabs mask appears {merged.count(mask)} times after merging"}))
+            return
+        if (base + merged.find(mask)) % 16 != 0:
+            print(json.dumps({"success": False, "message": "fabs mask is not 16-byte aligned"}))
+            return
+
+        print(json.dumps({"success": True, "message": f".rodata {len(unmerged)} -> {len(merged)} bytes"}))
+
+    except Exception as e:
+        print(json.dumps({"success": False, "message": f"Judge error: {str(e)}"}))
+
+
+if __name__ == "__main__":
+    judge()
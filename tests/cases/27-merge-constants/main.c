@@ -0,0 +1,15 @@
+#include "minilibc.h"
+
+extern int scale_a(int x);
+extern int scale_b(int x);
+extern int distance_a(int x, int y);
+extern int distance_b(int x, int y);
+extern int offset_b(int x);
+
+int main(void)
+{
+    printf("%d %d\n", scale_a(4), scale_b(10));
+    printf("%d %d\n", distance_a(1, 8), distance_b(8, 1));
+    printf("%d\n", offset_b(6));
+    return 0;
+}
@@ -0,0 +1,21 @@
+// 用 -ffunction-sections 编译，每个函数各占一个节，链接时可以单独排序
+
+int cold_one(int x)
+{
+    return x * 11 + 3;
+}
+
+int hot_two(int x)
+{
+    return x + 2;
+}
+
+int cold_two(int x)
+{
+    return x * x - 7;
+}
+
+int hot_one(int x)
+{
+    return hot_two(x) * 2;
+}
@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+import json
+import os
+import sys
+
+
+def load_fle(path):
+    with open(path, "r") as f:
+        return json.load(f)
+
+
+def text_symbols(fle):
+    # 📤: 名字 大小 节内偏移
+    symbols = {}
+    for line in fle.get(".text", []):
+        if isinstance(line, str) and line.startswith("📤:"):
+            name, size, offset = line.split(":", 1)[1].split()
+            symbols[name] = (int(offset), int(size))
+    return symbols
+
+
+def judge():
+    try:
+        input_data = json.load(sys.stdin)
+        build_dir = os.path.join(input_data["test_dir"], "build")
+        try:
+            program = load_fle(os.path.join(build_dir, "program"))
+        except Exception as e:
+            print(json.dumps({"success": False, "message": f"Failed to load program: {str(e)}"}))
+            return
+
+        symbols = text_symbols(program)
+        ordered = ["hot_one", "hot_two", "main"]
+        for name in ordered + ["cold_one", "cold_two", "_start"]:
+            if name not in symbols:
+                print(json.dumps({"success": False, "message": f"Symbol '{name}' is missing"}))
+                return
+
+        # 列出的函数依次紧挨着排在 .text 开头
+        expected = 0
+        for name in ordered:
+            offset, size = symbols[name]
+            if offset != expected:
+                print(json.dumps({"success": False, "message": f"{name} is at offset {offset}, expected {expected}"}))
+                return
+            expected += size
+
+        # 其他函数都在它们后面
+        for name, (offset, _) in symbols.items():
+            if name not in ordered and offset < expected:
+                print(json.dumps({"success": False, "message": f"Unlisted function {name} is placed before the ordered ones"}))
+                return
+
+        print(json.dumps({"success": True, "message": f"Ordered functions occupy the first {expected} bytes of .text"}))
+
+    except Exception as e:
+        print(json.dumps({"success": False, "message": f"Judge error: {str(e)}"}))
+
+
+if __name__ == "__main__":
+    judge()
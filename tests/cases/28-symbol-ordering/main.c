@@ -0,0 +1,15 @@
+#include "minilibc.h"
+
+extern int cold_one(int x);
+extern int cold_two(int x);
+extern int hot_one(int x);
+
+int main(void)
+{
+    int sum = 0;
+    for (int i = 0; i < 10; ++i) {
+        sum += hot_one(i);
+    }
+    printf("%d %d %d\n", sum, cold_one(1), cold_two(3));
+    return 0;
+}
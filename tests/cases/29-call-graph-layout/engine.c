@@ -0,0 +1,56 @@
+// 热函数和很大的冷函数（错误处理）交错定义，按输入顺序排布时热路径散落在很多页上。
+// 用 -ffunction-sections 编译，每个函数各占一个节
+
+// 冷函数体用 nop 填充到 3KB 左右，实际运行时从不调用
+#define COLD_BODY(n) \
+    asm volatile(".skip 3000, 0x90"); \
+    return -(n)
+
+__attribute__((noinline)) int report_overflow(int x)
+{
+    COLD_BODY(x);
+}
+
+__attribute__((noinline)) int hot_mix(int x)
+{
+    return (x * 2654435761u) >> 7;
+}
+
+__attribute__((noinline)) int report_underflow(int x)
+{
+    COLD_BODY(x + 1);
+}
+
+__attribute__((noinline)) int hot_step(int x)
+{
+    int y = hot_mix(x);
+    if (y < 0) return report_overflow(y);
+    return y & 1023;
+}
+
+__attribute__((noinline)) int report_corrupt(int x)
+{
+    COLD_BODY(x + 2);
+}
+
+__attribute__((noinline)) int hot_update(int acc, int x)
+{
+    int v = hot_step(x);
+    if (v > 1023) return report_underflow(v);
+    return acc + v;
+}
+
+__attribute__((noinline)) int report_timeout(int x)
+{
+    COLD_BODY(x + 3);
+}
+
+__attribute__((noinline)) int hot_run(int n)
+{
+    int acc = 0;
+    for (int i = 0; i < n; ++i) {
+        acc = hot_update(acc, i);
+        if (acc < 0) return report_corrupt(acc) + report_timeout(i);
+    }
+    return acc;
+}
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+import json
+import os
+import sys
+
+PAGE_SIZE = 4096
+CACHE_LINE = 64
+
+# profile.txt 里权重高的函数，也就是运行时反复执行的热路径
+HOT = ["main", "hot_run", "hot_update", "hot_step", "hot_mix"]
+COLD = ["report_overflow", "report_underflow", "report_timeout"]
+
+
+def load_fle(path):
+    with open(path, "r") as f:
+        return json.load(f)
+
+
+def text_symbols(fle):
+    # 📤: 名字 大小 节内偏移 -> (运行时地址, 大小)
+    base = next(phdr["vaddr"] for phdr in fle["phdrs"] if phdr["name"] == ".text")
+    symbols = {}
+    for line in fle.get(".text", []):
+        if isinstance(line, str) and line.startswith("📤:"):
+            name, size, offset = line.split(":", 1)[1].split()
+            symbols[name] = (base + int(offset), int(size))
+    return symbols
+
+
+def touched(symbols, names, unit):
+    # 执行这些函数会碰到的页（或缓存行）数
+    units = set()
+    for name in names:
+        addr, size = symbols[name]
+        units.update(range(addr // unit, (addr + max(size, 1) - 1) // unit + 1))
+    return len(units)
+
+
+def judge():
+    try:
+        input_data = json.load(sys.stdin)
+        build_dir = os.path.join(input_data["test_dir"], "build")
+        try:
+            baseline = text_symbols(load_fle(os.path.join(build_dir, "baseline")))
+            program = text_symbols(load_fle(os.path.join(build_dir, "program")))
+        except Exception as e:
+            print(json.dumps({"success": False, "message": f"Failed to load programs: {str(e)}"}))
+            return
+
+        for name in HOT + COLD:
+            if name not in program:
+                print(json.dumps({"success": False, "message": f"Symbol '{name}' is missing"}))
+                return
+
+        base_pages, new_pages = touched(baseline, HOT, PAGE_SIZE), touched(program, HOT, PAGE_SIZE)
+        base_lines, new_lines = touched(baseline, HOT, CACHE_LINE), touched(program, HOT, CACHE_LINE)
+        if new_pages != 1:
+            print(json.dumps({"success": False, "message": f"Hot path spans {new_pages} pages, expected 1"}))
+            return
+        if not new_lines < base_lines:
+            print(json.dumps({"success": False, "message": f"Hot path cache lines did not shrink: {base_lines} -> {new_lines}"}))
+            return
+
+        # 没出现在调用图里的冷函数排在所有热函数后面
+        hot_end = max(program[name][0] + program[name][1] for name in HOT)
+        for name in COLD:
+            if program[name][0] < hot_end:
+                print(json.dumps({"success": False, "message": f"Cold function {name} is placed inside the hot path"}))
+                return
+
+        print(json.dumps({"success": True, "message": f"hot path pages {base_pages} -> {new_pages}, cache lines {base_lines} -> {new_lines}"}))
+
+    except Exception as e:
+        print(json.dumps({"success": False, "message": f"Judge error: {str(e)}"}))
+
+
+if __name__ == "__main__":
+    judge()
@@ -0,0 +1,9 @@
+#include "minilibc.h"
+
+extern int hot_run(int n);
+
+int main(void)
+{
+    printf("%d\n", hot_run(100000));
+    return 0;
+}
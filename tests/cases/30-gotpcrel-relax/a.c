@@ -0,0 +1,10 @@
+int counter = 40;
+int table[4] = {1, 2, 3, 4};
+
+int bump(int x)
+{
+    counter += x;
+    return counter;
+}
+
+int twice(int x) { return 2 * x; }
@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+import json
+import os
+import subprocess
+import sys
+
+
+def load_fle(path):
+    with open(path, "r") as f:
+        return json.load(f)
+
+
+def got_size(fle):
+    # 有节头时按节头找（段里可能有多个节），否则段就是同名的节
+    for header in fle.get("shdrs") or fle["phdrs"]:
+        if header["name"] == ".got":
+            return header["size"]
+    return 0
+
+
+def judge():
+    try:
+        input_data = json.load(sys.stdin)
+        test_dir = input_data["test_dir"]
+        build_dir = os.path.join(test_dir, "build")
+        root_dir = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(test_dir))))
+        try:
+            program = load_fle(os.path.join(build_dir, "program"))
+            program_got = load_fle(os.path.join(build_dir, "program_got"))
+        except Exception as e:
+            print(json.dumps({"success": False, "message": f"Failed to load programs: {str(e)}"}))
+            return
+
+        # 全部访问都改写成了直接访问，不需要 GOT
+        if got_size(program) != 0:
+            print(json.dumps({"success": False, "message": f"Relaxed program still has a {got_size(program)}-byte GOT"}))
+            return
+
+        # 不能改写的 .gotpcrel 每个符号一个槽位：printf bump counter table twice
+        if got_size(program_got) != 5 * 8:
+            print(json.dumps({"success": False, "message": f"Expected 5 GOT slots, got {got_size(program_got)} bytes"}))
+            return
+
+        # 改写后的程序里不再有经 GOT 的间接调用
+        disasm = subprocess.run([os.path.join(root_dir, "disasm"), os.path.join(build_dir, "program"), ".text"],
+                                capture_output=True, text=True)
+        if disasm.returncode != 0:
+            print(json.dumps({"success": False, "message": f"disasm failed: {disasm.stderr}"}))
+            return
+        if "ff 15" in disasm.stdout or "ff 25" in disasm.stdout:
+            print(json.dumps({"success": False, "message": "Indirect call through the GOT left in relaxed program"}))
+            return
+
+        print(json.dumps({"success": True, "message": f"GOT {got_size(program_got)} -> {got_size(program)} bytes"}))
+
+    except Exception as e:
+        print(json.dumps({"success": False, "message": f"Judge error: {str(e)}"}))
+
+
+if __name__ == "__main__":
+    judge()
@@ -0,0 +1,19 @@
+#include "minilibc.h"
+
+extern int counter;
+extern int table[4];
+int bump(int x);
+int twice(int x);
+
+static int apply(int (*f)(int), int x) { return f(x); }
+
+int main(void)
+{
+    int sum = 0;
+    for (int i = 0; i < 4; ++i) sum += table[i];
+    printf("sum = %d\n", sum);
+    printf("bump = %d\n", bump(2));
+    printf("counter = %d\n", counter);
+    printf("apply = %d\n", apply(twice, 21));
+    return 0;
+}
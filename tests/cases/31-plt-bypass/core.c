@@ -0,0 +1,7 @@
+// 与 ops.c 链接进同一个共享库，对它的调用和访问都不应经过 PLT/GOT
+int core_bias = 7;
+
+int core_scale(int x)
+{
+    return x * 3;
+}
@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+import json
+import os
+import sys
+
+SCRIPT_DIR = os.path.dirname(__file__)
+ROOT_DIR = os.path.abspath(os.path.join(SCRIPT_DIR, "..", ".."))
+if ROOT_DIR not in sys.path:
+    sys.path.append(ROOT_DIR)
+
+from common.fle_utils import extract_dynamic_relocs
+
+
+def load_fle(path):
+    with open(path, "r") as f:
+        return json.load(f)
+
+
+def section(fle, name):
+    """输出节的 (地址, 大小)：有节头时按节头找（段里可能有多个节），否则段就是同名的节"""
+    for shdr in fle.get("shdrs", []):
+        if shdr["name"] == name:
+            return shdr["addr"], shdr["size"]
+    for phdr in fle["phdrs"]:
+        if phdr["name"] == name:
+            return phdr["vaddr"], phdr["size"]
+    return None, 0
+
+
+def section_bytes(fle, name):
+    data = []
+    for line in fle.get(name, []):
+        if isinstance(line, str) and line.startswith("🔢:"):
+            data.extend(int(b, 16) for b in line.split(":", 1)[1].split())
+    return data
+
+
+def check_module(fle, imports, functions):
+    """每个导入符号一个 GOT 槽位，每个导入函数一个 PLT 表项，且 PLT 表项各自指向不同的槽位"""
+    symbols = sorted(r["symbol"] for r in extract_dynamic_relocs(fle))
+    if symbols != sorted(imports):
+        return f"dynamic relocations {symbols}, expected {sorted(imports)}"
+    got_addr, got_size = section(fle, ".got")
+    if got_size != 8 * len(imports):
+        return f"expected {len(imports)} GOT slots, got {got_size} bytes"
+    plt_addr, plt_size = section(fle, ".plt")
+    if plt_size != 6 * functions:
+        return f"expected {functions} PLT stubs, got {plt_size} bytes"
+    stubs = section_bytes(fle, ".plt")
+    targets = set()
+    for i in range(functions):
+        stub = stubs[6 * i: 6 * i + 6]
+        if stub[:2] != [0xff, 0x25]:
+            return f"PLT stub {i} is not an indirect jmp"
+        disp = int.from_bytes(bytes(stub[2:]), "little", signed=True)
+        target = plt_addr + 6 * i + 6 + disp
+        if not got_addr <= target < got_addr + got_size or (target - got_addr) % 8:
+            return f"PLT stub {i} does not jump through a GOT slot"
+        targets.add(target)
+    if len(targets) != functions:
+        return "PLT stubs share GOT slots"
+    return None
+
+
+def judge():
+    try:
+        input_data = json.load(sys.stdin)
+        build_dir = os.path.join(input_data["test_dir"], "build")
+        try:
+            libops = load_fle(os.path.join(build_dir, "libops.so"))
+            program = load_fle(os.path.join(build_dir, "program"))
+        except Exception as e:
+            print(json.dumps({"success": False, "message": f"Failed to load outputs: {str(e)}"}))
+            return
+
+        # core_scale / core_bias 在 libops.so 里有定义，只有 base_add 需要导入
+        error = check_module(libops, ["base_add"], 1)
+        if error:
+            print(json.dumps({"success": False, "message": f"libops.so: {error}"}))
+            return
+        error = check_module(program, ["base_add", "ops_run"], 2)
+        if error:
+            print(json.dumps({"success": False, "message": f"program: {error}"}))
+            return
+
+        print(json.dumps({"success": True, "message": "one GOT slot per import, one PLT stub per imported function"}))
+
+    except Exception as e:
+        print(json.dumps({"success": False, "message": f"Judge error: {str(e)}"}))
+
+
+if __name__ == "__main__":
+    judge()
@@ -0,0 +1,4 @@
+int base_add(int a, int b)
+{
+    return a + b;
+}
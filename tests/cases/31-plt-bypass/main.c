@@ -0,0 +1,11 @@
+#include "minilibc.h"
+
+int ops_run(int x);
+int base_add(int a, int b);
+
+int main(void)
+{
+    printf("ops_run(4) = %d\n", ops_run(4));
+    printf("base_add(2, 3) = %d\n", base_add(2, 3));
+    return 0;
+}
@@ -0,0 +1,13 @@
+extern int core_bias;
+int core_scale(int x);
+int base_add(int a, int b); // 由 libbase.so 提供
+
+int ops_run(int x)
+{
+    int sum = 0;
+    for (int i = 0; i < x; ++i) {
+        sum = base_add(sum, core_scale(i));
+        sum = base_add(sum, core_bias);
+    }
+    return core_scale(sum);
+}
@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+import json
+import os
+import sys
+
+PAGE_SIZE = 4096
+# 权限位：X=1 W=2 R=4（见 fle.hpp 的 PHF）
+X, W, R = 1, 2, 4
+
+
+def load_fle(path):
+    with open(path, "r") as f:
+        return json.load(f)
+
+
+def pages(fle):
+    # 加载器按段 mmap，每个段占据的页数
+    return sum((p["size"] + PAGE_SIZE - 1) // PAGE_SIZE for p in fle["phdrs"] if p["size"] > 0)
+
+
+def syscalls(fle):
+    # FLE_exec 为每个段调用一次 mmap 和一次 mprotect
+    return 2 * sum(1 for p in fle["phdrs"] if p["size"] > 0)
+
+
+def judge():
+    try:
+        input_data = json.load(sys.stdin)
+        build_dir = os.path.join(input_data["test_dir"], "build")
+        try:
+            baseline = load_fle(os.path.join(build_dir, "baseline"))
+            program = load_fle(os.path.join(build_dir, "program"))
+        except Exception as e:
+            print(json.dumps({"success": False, "message": f"Failed to load programs: {str(e)}"}))
+            return
+
+        # 每种权限恰好一个段，段首按页对齐
+        flags = [p["flags"] for p in program["phdrs"]]
+        if flags != [R | X, R, R | W]:
+            print(json.dumps({"success": False, "message": f"Expected RX, R, RW segments, got flags {flags}"}))
+            return
+        for p in program["phdrs"]:
+            if p["vaddr"] % PAGE_SIZE:
+                print(json.dumps({"success": False, "message": f"Segment {p['name']} is not page-aligned"}))
+                return
+
+        # 每个节都落在权限相同的段里，而且在段内按自然对齐摆放
+        shdrs = program.get("shdrs", [])
+        names = {s["name"] for s in shdrs}
+        for name in [".text", ".rodata", ".data", ".bss"]:
+            if name not in names:
+                print(json.dumps({"success": False, "message": f"Section {name} is missing from the section headers"}))
+                return
+        for s in shdrs:
+            seg = [p for p in program["phdrs"] if p["vaddr"] <= s["addr"] and s["addr"] + s["size"] <= p["vaddr"] + p["size"]]
+            if len(seg) != 1:
+                print(json.dumps({"success": False, "message": f"Section {s['name']} is not inside exactly one segment"}))
+                return
+            if s["addr"] % 8:
+                print(json.dumps({"success": False, "message": f"Section {s['name']} is misaligned at {hex(s['addr'])}"}))
+                return
+
+        base_pages, new_pages = pages(baseline), pages(program)
+        base_calls, new_calls = syscalls(baseline), syscalls(program)
+        if not new_pages < base_pages or not new_calls < base_calls:
+            print(json.dumps({"success": False, "message": f"No improvement: pages {base_pages} -> {new_pages}, syscalls {base_calls} -> {new_calls}"}))
+            return
+
+        print(json.dumps({"success": True, "message": f"pages {base_pages} -> {new_pages}, mmap+mprotect {base_calls} -> {new_calls}"}))
+
+    except Exception as e:
+        print(json.dumps({"success": False, "message": f"Judge error: {str(e)}"}))
+
+
+if __name__ == "__main__":
+    judge()
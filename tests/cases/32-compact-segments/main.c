@@ -0,0 +1,18 @@
+#include "minilibc.h"
+
+// 每种输出节都用到一点：.text、.rodata、.data、.bss
+static const int squares[8] = {0, 1, 4, 9, 16, 25, 36, 49};
+int scale = 3;
+int history[64];
+
+int main(void)
+{
+    int sum = 0;
+    for (int i = 0; i < 8; ++i) {
+        history[i] = squares[i] * scale;
+        sum += history[i];
+    }
+    printf("sum = %d\n", sum);
+    printf("history[7] = %d\n", history[7]);
+    return 0;
+}
@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+import json
+import os
+import sys
+
+# -ffunction-sections 下每个函数一个输入节，都应该从 32 字节边界开始
+FUNCTIONS = ["main", "pad_func", "dot4", "vec_add"]
+ALIGN = 32
+
+
+def load_fle(path):
+    with open(path, "r") as f:
+        return json.load(f)
+
+
+def text_symbols(fle):
+    # 📤: 名字 大小 节内偏移 -> 运行时地址
+    base = next(phdr["vaddr"] for phdr in fle["phdrs"] if phdr["name"] == ".text")
+    symbols = {}
+    for line in fle.get(".text", []):
+        if isinstance(line, str) and line.startswith("📤:"):
+            name, size, offset = line.split(":", 1)[1].split()
+            symbols[name] = base + int(offset)
+    return symbols
+
+
+def judge():
+    try:
+        input_data = json.load(sys.stdin)
+        build_dir = os.path.join(input_data["test_dir"], "build")
+        try:
+            program = text_symbols(load_fle(os.path.join(build_dir, "program")))
+            aligned = text_symbols(load_fle(os.path.join(build_dir, "aligned")))
+        except Exception as e:
+            print(json.dumps({"success": False, "message": f"Failed to load programs: {str(e)}"}))
+            return
+
+        for name in FUNCTIONS:
+            if name not in aligned:
+                print(json.dumps({"success": False, "message": f"Symbol '{name}' is missing"}))
+                return
+            if aligned[name] % ALIGN:
+                print(json.dumps({"success": False, "message": f"{name} at {hex(aligned[name])} is not {ALIGN}-byte aligned"}))
+                return
+
+        before = sum(1 for name in FUNCTIONS if program[name] % ALIGN == 0)
+        print(json.dumps({"success": True, "message": f"{ALIGN}-byte aligned functions: {before} -> {len(FUNCTIONS)} of {len(FUNCTIONS)}"}))
+
+    except Exception as e:
+        print(json.dumps({"success": False, "message": f"Judge error: {str(e)}"}))
+
+
+if __name__ == "__main__":
+    judge()
@@ -0,0 +1,19 @@
+#include "minilibc.h"
+
+extern const float weights[8];
+extern struct Line {
+    long counter;
+    long pad[7];
+} line;
+int pad_func(int x);
+int dot4(void);
+int vec_add(int a, int b);
+
+int main(void)
+{
+    printf("weights aligned: %d\n", ((long)weights & 31) == 0);
+    printf("line aligned: %d\n", ((long)&line & 63) == 0);
+    printf("dot4 = %d\n", dot4());
+    printf("vec_add = %d\n", vec_add(pad_func(1), 2));
+    return 0;
+}
@@ -0,0 +1,8 @@
+// 奇数大小的 .rodata / .data，把后面目标文件的节推到不对齐的位置
+const char pad_tag[3] = {1, 2, 3};
+char pad_flag = 1;
+
+int pad_func(int x)
+{
+    return x + pad_tag[0] + pad_flag;
+}
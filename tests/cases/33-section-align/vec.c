@@ -0,0 +1,25 @@
+// 要求 16/32/64 字节对齐的数据：movaps 遇到不对齐的地址会触发 #GP
+typedef float v4sf __attribute__((vector_size(16)));
+
+__attribute__((aligned(32))) const float weights[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+struct Line {
+    long counter;
+    long pad[7];
+} __attribute__((aligned(64)));
+
+struct Line line = {5, {0}};
+
+int dot4(void)
+{
+    v4sf w;
+    // 显式的对齐加载，地址不是 16 的倍数就会崩溃
+    __asm__ volatile("movaps %1, %0" : "=x"(w) : "m"(*(const v4sf*)weights));
+    float s = w[0] + w[1] + w[2] + w[3];
+    return (int)s + (int)line.counter;
+}
+
+int vec_add(int a, int b)
+{
+    return a + b;
+}
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+# 在两个临时目录里重放每个测试用例的 cc/ar/ld 步骤，
+# 一边给 ld 加 --threads=1，一边加 --threads=N，逐字节比较每次 ld 的输出
+import filecmp
+import os
+import subprocess
+import sys
+import tempfile
+import tomllib
+from pathlib import Path
+
+THREADS = 8
+TOOLS = ("cc", "ar", "ld")
+
+
+def substitute(value, dirs):
+    for var, path in dirs.items():
+        value = value.replace(var, str(path))
+    return value
+
+
+def output_of(args):
+    # ld 的输出文件（-o 之后的参数）
+    for i, arg in enumerate(args[:-1]):
+        if arg == "-o":
+            return args[i + 1]
+    return "a.out"
+
+
+def replay(case_dir, root_dir, common_dir, build_dir, threads):
+    # 返回每个 ld 步骤的 (步骤名, 返回码, 标准输出, 输出文件)
+    with open(case_dir / "config.toml", "rb") as f:
+        config = tomllib.load(f)
+    dirs = {
+        "${root_dir}": root_dir,
+        "${test_dir}": case_dir,
+        "${common_dir}": common_dir,
+        "${build_dir}": build_dir,
+    }
+    results = []
+    for step in config.get("run", []):
+        command = substitute(step["command"].strip(), dirs)
+        tool = os.path.basename(command)
+        if os.path.dirname(command) != str(root_dir) or tool not in TOOLS:
+            continue
+        args = [substitute(str(arg), dirs) for arg in step.get("args", [])]
+        if tool == "ld":
+            # --stats 打印的耗时和内存每次都不一样，不参与比较
+            args = [arg for arg in args if arg != "--stats" and not arg.startswith("--stats=")]
+            args.append(f"--threads={threads}")
+        env = os.environ.copy()
+        for key, value in step.get("env", {}).items():
+            env[key] = substitute(str(value), dirs)
+        proc = subprocess.run([command] + args, cwd=case_dir, env=env, capture_output=True, text=True)
+        if tool == "ld":
+            # 输出里的路径换回变量名，两个目录的结果才能直接比较
+            stdout = proc.stdout.replace(str(build_dir), "${build_dir}")
+            results.append((step.get("name", "ld"), proc.returncode, stdout, output_of(args)))
+    return results
+
+
+def main():
+    root_dir = Path(sys.argv[1]).resolve()
+    cases_dir = root_dir / "tests" / "cases"
+    common_dir = root_dir / "tests" / "common"
+    this_case = Path(__file__).resolve().parent
+
+    cases = sorted((d for d in cases_dir.iterdir() if (d / "config.toml").exists() and d != this_case),
+                   key=lambda d: int(d.name.split("-")[0]))
+    failures = []
+    links = 0
+    for case_dir in cases:
+        with tempfile.TemporaryDirectory() as tmp:
+            serial_dir = Path(tmp) / "serial"
+            parallel_dir = Path(tmp) / "parallel"
+            serial_dir.mkdir()
+            parallel_dir.mkdir()
+            serial = replay(case_dir, root_dir, common_dir, serial_dir, 1)
+            parallel = replay(case_dir, root_dir, common_dir, parallel_dir, THREADS)
+            for (name, code_a, out_a, file_a), (_, code_b, out_b, file_b) in zip(serial, parallel):
+                links += 1
+                if code_a != code_b or out_a != out_b:
+                    failures.append(f"{case_dir.name}: '{name}' behaves differently")
+                elif os.path.exists(file_a) != os.path.exists(file_b):
+                    failures.append(f"{case_dir.name}: '{name}' output exists only with one thread count")
+                elif os.path.exists(file_a) and not filecmp.cmp(file_a, file_b, shallow=False):
+                    failures.append(f"{case_dir.name}: '{name}' output differs")
+
+    for failure in failures:
+        print(failure)
+    print(f"{links} links compared, {len(failures)} differ")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
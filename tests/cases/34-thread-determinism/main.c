@@ -0,0 +1,7 @@
+#include "minilibc.h"
+
+int main(void)
+{
+    printf("hello\n");
+    return 0;
+}
@@ -0,0 +1,39 @@
+#!/usr/bin/env python3
+import json
+import os
+import sys
+
+
+def judge():
+    try:
+        input_data = json.load(sys.stdin)
+        build_dir = os.path.join(input_data["test_dir"], "build")
+        try:
+            with open(os.path.join(build_dir, "program"), "r") as f:
+                program = json.load(f)
+        except Exception as e:
+            print(json.dumps({"success": False, "message": f"Failed to load program: {str(e)}"}))
+            return
+
+        # 两个静态库里被用到的成员都拉进来了，没被引用的 unused.fo 没有
+        labels = set()
+        for key, lines in program.items():
+            if key.startswith("."):
+                for line in lines:
+                    if line.startswith(("📤", "📎", "🏷️")):
+                        labels.add(line.split(":", 1)[1].split()[0])
+        for name in ["parse", "lex", "note"]:
+            if name not in labels:
+                print(json.dumps({"success": False, "message": f"{name} is missing from the program"}))
+                return
+        if "unused_helper" in labels:
+            print(json.dumps({"success": False, "message": "unused.fo was linked although nothing references it"}))
+            return
+
+        print(json.dumps({"success": True, "message": "Group resolved both archives and pulled only the needed members"}))
+    except Exception as e:
+        print(json.dumps({"success": False, "message": f"Judge error: {str(e)}"}))
+
+
+if __name__ == "__main__":
+    judge()
@@ -0,0 +1,7 @@
+// liblex.fa
+int note(int x);
+
+int lex(int x)
+{
+    return note(x) + 1;
+}
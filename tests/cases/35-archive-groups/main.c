@@ -0,0 +1,9 @@
+#include "minilibc.h"
+
+int parse(int x);
+
+int main(void)
+{
+    printf("parse(3) = %d\n", parse(3));
+    return 0;
+}
@@ -0,0 +1,5 @@
+// libparse.fa：lex 反过来要用这里的 note，两个静态库互相依赖
+int note(int x)
+{
+    return x + 100;
+}
@@ -0,0 +1,7 @@
+// libparse.fa：parse 要用 liblex.fa 里的 lex
+int lex(int x);
+
+int parse(int x)
+{
+    return lex(x) * 2;
+}
@@ -0,0 +1,5 @@
+// 没有人引用，不应被拉入
+int unused_helper(int x)
+{
+    return x * 3;
+}
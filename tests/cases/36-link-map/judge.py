@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+import json
+import os
+import re
+import sys
+
+MEMBER = "libtable.fa(table.fo)"
+
+
+def fail(message):
+    print(json.dumps({"success": False, "message": message}))
+
+
+def parse_map(path):
+    # 输出节：地址 大小 对齐 名字；输入节：地址 偏移 大小 对齐 文件:(节)；符号：地址 偏移 大小 名字
+    out_sections, inputs, symbols, files = {}, [], {}, {}
+    with open(path, "r") as f:
+        lines = f.read().splitlines()
+    in_summary = False
+    for line in lines[1:]:
+        if line.startswith("Bytes per input file"):
+            in_summary = True
+            continue
+        fields = line.split()
+        if not fields:
+            continue
+        if in_summary:
+            if fields[0].isdigit():
+                files[fields[3]] = tuple(int(x) for x in fields[:3])
+            continue
+        if len(fields) == 4 and fields[3].startswith("."):
+            out_sections[fields[3]] = (int(fields[0], 16), int(fields[1], 16))
+        elif len(fields) >= 5 and ":(" in fields[4]:
+            inputs.append((int(fields[0], 16), int(fields[2], 16), fields[4]))
+        elif len(fields) >= 4 and not fields[3].startswith("<"):
+            symbols.setdefault(fields[3], int(fields[0], 16))
+    return out_sections, inputs, symbols, files
+
+
+def judge():
+    try:
+        input_data = json.load(sys.stdin)
+        build_dir = os.path.join(input_data["test_dir"], "build")
+        try:
+            with open(os.path.join(build_dir, "program"), "r") as f:
+                program = json.load(f)
+            out_sections, inputs, symbols, files = parse_map(os.path.join(build_dir, "program.map"))
+        except Exception as e:
+            fail(f"Failed to load program or map: {str(e)}")
+            return
+
+        # 输出节的地址和大小与程序的节头一致
+        for shdr in program["shdrs"]:
+            if out_sections.get(shdr["name"]) != (shdr["addr"], shdr["size"]):
+                fail(f"{shdr['name']}: map says {out_sections.get(shdr['name'])}, program has {(shdr['addr'], shdr['size'])}")
+                return
+
+        # 符号地址与程序里的一致（程序的符号按 "📤: 名字 大小 节内偏移" 记在节里）
+        addrs = {shdr["name"]: shdr["addr"] for shdr in program["shdrs"]}
+        for name in ["main", "table_sum", "greeting", "table", "scratch"]:
+            expected = None
+            for sec, lines in program.items():
+                if not sec.startswith(".") or not isinstance(lines, list):
+                    continue
+                for entry in lines:
+                    m = re.match(r"^📤: (\S+) \d+ (\d+)$", entry)
+                    if m and m.group(1) == name:
+                        expected = addrs[sec] + int(m.group(2))
+            if expected is None or symbols.get(name) != expected:
+                fail(f"Symbol {name}: map says {symbols.get(name)}, program has {expected}")
+                return
+
+        # 静态库成员按 库(成员) 命名，被 --gc-sections 回收的节不出现
+        names = [what for _, _, what in inputs]
+        if f"{MEMBER}:(.text.table_sum)" not in names or f"{MEMBER}:(.bss.scratch)" not in names:
+            fail(f"Archive member sections are missing: {names}")
+            return
+        if any("never_called" in what for what in names):
+            fail("A section removed by --gc-sections is listed in the map")
+            return
+
+        # 每个输入文件一行，合计等于各行之和
+        if set(files) != {"main.fo", "minilibc.fo", MEMBER, "(total)"}:
+            fail(f"Unexpected per-file summary: {sorted(files)}")
+            return
+        if files[MEMBER][2] == 0:
+            fail("The removed section is not counted as discarded bytes")
+            return
+        for col in range(3):
+            if sum(v[col] for k, v in files.items() if k != "(total)") != files["(total)"][col]:
+                fail("Per-file byte counts do not add up to the total")
+                return
+
+        print(json.dumps({"success": True, "message": "Link map matches the program"}))
+    except Exception as e:
+        fail(f"Judge error: {str(e)}")
+
+
+if __name__ == "__main__":
+    judge()
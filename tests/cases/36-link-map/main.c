@@ -0,0 +1,11 @@
+#include "minilibc.h"
+
+int table_sum(void);
+const char* greeting(void);
+
+int main(void)
+{
+    printf("%d\n", table_sum());
+    printf(greeting());
+    return 0;
+}
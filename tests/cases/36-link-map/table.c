@@ -0,0 +1,23 @@
+// 有 .text、.data 和 .bss，另有一个没人调用的函数，--gc-sections 时会被回收
+int table[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+int scratch[256];
+
+int table_sum(void)
+{
+    int sum = 0;
+    for (int i = 0; i < 16; ++i) {
+        scratch[i] = table[i];
+        sum += scratch[i];
+    }
+    return sum;
+}
+
+int never_called(int x)
+{
+    return x * x + table[3];
+}
+
+const char* greeting(void)
+{
+    return "hello from the map\n";
+}
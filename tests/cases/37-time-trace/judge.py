@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+import json
+import os
+import sys
+
+# 每个阶段至少一个区间，后面是它必须带的计数
+PHASES = {
+    "input loading": ["inputs"],
+    "load": ["bytes", "symbols"],
+    "archive resolution": ["objects", "members pulled"],
+    "symbol table": ["symbols"],
+    "section merging": ["bytes"],
+    "GOT/PLT synthesis": ["got entries", "plt entries"],
+    "relocation": ["relocations"],
+    "relocate": ["relocations"],
+    "entry resolution": [],
+    "output writing": ["bytes"],
+}
+
+
+def fail(message):
+    print(json.dumps({"success": False, "message": message}))
+
+
+def judge():
+    try:
+        input_data = json.load(sys.stdin)
+        build_dir = os.path.join(input_data["test_dir"], "build")
+        try:
+            with open(os.path.join(build_dir, "trace.json"), "r") as f:
+                trace = json.load(f)
+        except Exception as e:
+            fail(f"Failed to load trace: {str(e)}")
+            return
+
+        events = trace.get("traceEvents")
+        if not isinstance(events, list) or not events:
+            fail("traceEvents is missing or empty")
+            return
+        for e in events:
+            if e.get("ph") != "X" or not all(k in e for k in ("name", "ts", "dur", "pid", "tid")):
+                fail(f"Not a complete event: {e}")
+                return
+
+        by_name = {}
+        for e in events:
+            by_name.setdefault(e["name"], []).append(e)
+        for name, keys in PHASES.items():
+            if name not in by_name:
+                fail(f"No span for phase '{name}'")
+                return
+            for e in by_name[name]:
+                missing = [k for k in keys if k not in e.get("args", {})]
+                if missing:
+                    fail(f"Span '{name}' lacks {missing}")
+                    return
+
+        # 每个输入文件一个 load 区间，文件名放在 detail 里
+        loads = sorted(os.path.basename(e["args"].get("detail", "")) for e in by_name["load"])
+        if loads != ["main.fo", "minilibc.fo"]:
+            fail(f"Expected one load span per input, got {loads}")
+            return
+        if sum(e["args"]["relocations"] for e in by_name["relocate"]) != by_name["relocation"][0]["args"]["relocations"]:
+            fail("Per-object relocation counts do not add up to the phase total")
+            return
+
+        # 链接内部的阶段都落在 link 区间里
+        link = by_name["link"][0]
+        for name in ["archive resolution", "symbol table", "section merging", "relocation", "entry resolution"]:
+            e = by_name[name][0]
+            if e["ts"] < link["ts"] or e["ts"] + e["dur"] > link["ts"] + link["dur"]:
+                fail(f"Span '{name}' lies outside the link span")
+                return
+
+        print(json.dumps({"success": True, "message": f"{len(events)} trace events look good"}))
+    except Exception as e:
+        fail(f"Judge error: {str(e)}")
+
+
+if __name__ == "__main__":
+    judge()
@@ -0,0 +1,17 @@
+#include "minilibc.h"
+
+int counter;
+
+int add(int a, int b)
+{
+    return a + b;
+}
+
+int main(void)
+{
+    for (int i = 0; i < 5; ++i) {
+        counter = add(counter, i);
+    }
+    printf("counter = %d\n", counter);
+    return 0;
+}
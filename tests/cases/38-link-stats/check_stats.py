@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+# 用 --stats=json 重新链接一次，再从输入文件里数出符号和重定位，和统计结果逐项比较
+import json
+import subprocess
+import sys
+from pathlib import Path
+
+# .fo 里重定位的写法 -> RelocationType
+RELOC_TYPES = {
+    "rel": "R_X86_64_PC32",
+    "abs": "R_X86_64_32",
+    "abs64": "R_X86_64_64",
+    "abs32s": "R_X86_64_32S",
+    "gotpcrel": "R_X86_64_GOTPCREL",
+    "gotpcrelx": "R_X86_64_GOTPCRELX",
+}
+SYMBOL_TYPES = {"🏷️": "local", "📎": "weak", "📤": "global"}
+PHASES = ["input loading", "archive resolution", "symbol table", "section merging",
+          "GOT/PLT synthesis", "relocation", "entry resolution", "output writing"]
+
+
+def count(obj, symbols, relocs):
+    for name, lines in obj.items():
+        if name in ("type", "name", "shdrs") or not isinstance(lines, list):
+            continue
+        for line in lines:
+            prefix, _, content = line.partition(": ")
+            if prefix in SYMBOL_TYPES:
+                symbols[SYMBOL_TYPES[prefix]] += 1
+            elif prefix == "❓":
+                tag = content.split("(")[0].lstrip(".")
+                relocs[RELOC_TYPES[tag]] += 1
+
+
+def main():
+    ld, build_dir, common_dir = sys.argv[1], Path(sys.argv[2]), Path(sys.argv[3])
+    args = [ld, str(build_dir / "main.fo"), str(build_dir / "libgreet.so"), str(build_dir / "libutil.fa"),
+            str(common_dir / "minilibc.fo"), "-o", str(build_dir / "program_stats"), "--stats=json"]
+    proc = subprocess.run(args, capture_output=True, text=True)
+    if proc.returncode != 0:
+        print(f"ld failed: {proc.stderr.strip()}")
+        return 1
+    stats = json.loads(proc.stdout.strip().splitlines()[-1])
+
+    symbols = dict.fromkeys(["local", "weak", "global"], 0)
+    relocs = dict.fromkeys(RELOC_TYPES.values(), 0)
+    with open(build_dir / "libutil.fa") as f:
+        members = json.load(f)["members"]
+    util = next(m for m in members if "triple" in json.dumps(m, ensure_ascii=False))
+    for path in ["main.fo", "minilibc.fo"]:
+        with open((common_dir if path == "minilibc.fo" else build_dir) / path) as f:
+            count(json.load(f), symbols, relocs)
+    count(util, symbols, relocs)
+
+    with open(build_dir / "program_stats") as f:
+        program = json.load(f)
+    section_bytes = {shdr["name"]: shdr["size"] for shdr in program["shdrs"]}
+
+    errors = []
+
+    def expect(what, got, want):
+        if got != want:
+            errors.append(f"{what}: got {got}, expected {want}")
+
+    expect("inputs", stats["inputs"], 4)
+    expect("objects", stats["objects"], 3)
+    expect("archive_members_pulled", stats["archive_members_pulled"], 1)
+    for kind, n in symbols.items():
+        expect(f"{kind} symbols", stats["symbols"][kind], n)
+    if stats["symbols"]["undefined"] == 0:
+        errors.append("no undefined symbols counted")
+    expect("relocations", stats["relocations"], relocs)
+    if stats["plt_entries"] < 1 or stats["got_entries"] < 1:
+        errors.append(f"expected GOT/PLT entries for greet, got {stats['got_entries']}/{stats['plt_entries']}")
+    expect("section_bytes", stats["section_bytes"], section_bytes)
+    missing = [p for p in PHASES if p not in stats["phase_us"]]
+    if missing:
+        errors.append(f"phases missing: {missing}")
+    if stats["wall_us"] < stats["phase_us"].get("input loading", 0):
+        errors.append("total wall time is shorter than input loading")
+    if stats["peak_rss_kb"] <= 0:
+        errors.append("peak RSS not reported")
+
+    for error in errors:
+        print(error)
+    if errors:
+        return 1
+    print("stats match the inputs")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,9 @@
+#include "minilibc.h"
+
+int greet_count;
+
+void greet(int n)
+{
+    greet_count += n;
+    printf("greet %d\n", greet_count);
+}
@@ -0,0 +1,11 @@
+#include "minilibc.h"
+
+void greet(int n);
+int triple(int x);
+
+int main(void)
+{
+    greet(triple(2));
+    greet(triple(5));
+    return 0;
+}
@@ -0,0 +1,6 @@
+static int scale = 3;
+
+int triple(int x)
+{
+    return x * scale;
+}
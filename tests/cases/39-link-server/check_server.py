@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+# 起一个 ld-server，把同样的链接分别交给服务器和在本进程里做，比较退出码、输出和结果文件；
+# 再改动静态库，确认服务器按修改时间和内容哈希更新缓存
+import filecmp
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import time
+from pathlib import Path
+
+
+def main():
+    root_dir, build_dir, common_dir = Path(sys.argv[1]), Path(sys.argv[2]), Path(sys.argv[3])
+    ld, ar = str(root_dir / "ld"), str(root_dir / "ar")
+    errors = []
+
+    with tempfile.TemporaryDirectory() as tmp:
+        sock = os.path.join(tmp, "ld.sock")
+        server_env = dict(os.environ, FLE_LD_SERVER=sock)
+        local_env = dict(os.environ, FLE_LD_SERVER="off")
+        server = subprocess.Popen([str(root_dir / "ld-server")], env=server_env,
+                                  stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+        for _ in range(100):
+            if os.path.exists(sock):
+                break
+            time.sleep(0.05)
+        else:
+            server.kill()
+            print("ld-server did not create its socket")
+            return 1
+
+        def link(name, args, env):
+            # 相对路径从 build 目录解析，服务器要按客户端的当前目录处理
+            return subprocess.run([ld] + args + ["-o", name], cwd=build_dir, env=env, capture_output=True, text=True)
+
+        def compare(label, args):
+            served = link(f"{label}.server", args, server_env)
+            local = link(f"{label}.local", args, local_env)
+            if (served.returncode, served.stdout, served.stderr) != (local.returncode, local.stdout, local.stderr):
+                errors.append(f"{label}: server answered {served.returncode} {served.stdout!r} {served.stderr!r}, "
+                              f"local link gave {local.returncode} {local.stdout!r} {local.stderr!r}")
+            elif local.returncode == 0 and not filecmp.cmp(build_dir / f"{label}.server", build_dir / f"{label}.local", shallow=False):
+                errors.append(f"{label}: output differs from the local link")
+
+        inputs = ["main.fo", "libshout.fso", "libmath.fa", str(common_dir / "minilibc.fo")]
+        compare("first", inputs)
+        compare("cached", inputs)
+        compare("map", inputs + ["-Map", "cached.map"])
+        compare("missing", ["missing.fo", str(common_dir / "minilibc.fo")])
+        compare("bad-option", inputs + ["--no-such-option"])
+        # 只改修改时间：内容哈希不变，继续用缓存
+        os.utime(build_dir / "libmath.fa")
+        compare("touched", inputs)
+        # 内容变了（成员换了顺序）：重新解析
+        subprocess.run([ar, "libmath.fa", "square.fo", "cube.fo"], cwd=build_dir, check=True)
+        compare("rebuilt", inputs)
+        # 服务器处理的链接也能直接运行
+        run = subprocess.run([str(root_dir / "exec"), "rebuilt.server"], cwd=build_dir, capture_output=True, text=True,
+                             env=dict(os.environ, FLE_LIBRARY_PATH=str(build_dir)))
+        if run.stdout != "shout 27\n":
+            errors.append(f"program linked by the server printed {run.stdout!r}")
+
+        stop = subprocess.run([str(root_dir / "ld-server"), "--stop"], env=server_env, capture_output=True, text=True)
+        try:
+            log, _ = server.communicate(timeout=10)
+        except subprocess.TimeoutExpired:
+            server.kill()
+            log, _ = server.communicate()
+            errors.append("ld-server did not exit after --stop")
+        if stop.returncode != 0:
+            errors.append(f"ld-server --stop failed: {stop.stderr.strip()}")
+        if os.path.exists(sock):
+            errors.append("ld-server left its socket behind")
+
+    # 每次服务器链接一行：第几次、退出码、缓存命中情况
+    links = re.findall(r"link #(\d+) exited with (\d+) \(cached: (\d+) hits, (\d+) rehashed, (\d+) parsed\)", log)
+    cache = [tuple(int(x) for x in link[2:]) for link in links]
+    expected = [(0, 0, 2), (2, 0, 0), (2, 0, 0), (0, 0, 0), (0, 0, 0), (1, 1, 0), (1, 0, 1)]
+    if cache != expected:
+        errors.append(f"cache behaviour {cache}, expected {expected}\n{log}")
+
+    for error in errors:
+        print(error)
+    if errors:
+        return 1
+    print(f"{len(links)} server links match local links")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,8 @@
+void shout(int n);
+int cube(int x);
+
+int main(void)
+{
+    shout(cube(3));
+    return 0;
+}
@@ -0,0 +1,6 @@
+int not_defined_anywhere(void);
+
+int main(void)
+{
+    return not_defined_anywhere();
+}
@@ -0,0 +1,6 @@
+#include "minilibc.h"
+
+void shout(int n)
+{
+    printf("shout %d\n", n);
+}
@@ -0,0 +1,4 @@
+int square(int x)
+{
+    return x * x;
+}
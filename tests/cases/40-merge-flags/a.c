@@ -0,0 +1,15 @@
+// -fdata-sections 把这个普通数组放进 .rodata.str1，它只有 A 标志，不能与 b.c 的合并
+static const char str1[] = "hello";
+
+const char* str1_a(void)
+{
+    return str1;
+}
+
+// 同理，名字叫 cst8 的数组放进 .rodata.cst8，也只有 A 标志
+static const long cst8[1] = { 42 };
+
+const long* cst8_a(void)
+{
+    return cst8;
+}
@@ -0,0 +1,10 @@
+#include "minilibc.h"
+
+const char* long_a(void);
+const char* long_b(void);
+
+int main(void)
+{
+    printf("long strings aligned: %d\n", (((long)long_a() | (long)long_b()) & 7) == 0);
+    return 0;
+}
@@ -0,0 +1,13 @@
+static const char str1[] = "hello";
+
+const char* str1_b(void)
+{
+    return str1;
+}
+
+static const long cst8[1] = { 42 };
+
+const long* cst8_b(void)
+{
+    return cst8;
+}
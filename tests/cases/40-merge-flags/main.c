@@ -0,0 +1,13 @@
+#include "minilibc.h"
+
+const char* str1_a(void);
+const char* str1_b(void);
+const long* cst8_a(void);
+const long* cst8_b(void);
+
+int main(void)
+{
+    printf("str1 distinct: %d\n", str1_a() != str1_b());
+    printf("cst8 distinct: %d\n", cst8_a() != cst8_b());
+    return 0;
+}
@@ -0,0 +1,30 @@
+#!/usr/bin/env python3
+# 用法：mark_merge.py <in.fo> <out.fo> <节名前缀> <strings|constants> <entsize>
+# 把名字以前缀开头的节标成可合并的（SHF_MERGE，strings 时再加 SHF_STRINGS）。
+# gcc 不会给带重定位的节加 SHF_MERGE，这里手工标上，检查链接器不会去合并它们
+import json
+import sys
+
+SHF_MERGE, SHF_STRINGS = 16, 32
+
+
+def main():
+    src, dst, prefix, kind, entsize = sys.argv[1], sys.argv[2], sys.argv[3], sys.argv[4], int(sys.argv[5])
+    with open(src) as f:
+        obj = json.load(f)
+    marked = 0
+    for shdr in obj["shdrs"]:
+        if shdr["name"].startswith(prefix):
+            shdr["flags"] |= SHF_MERGE | (SHF_STRINGS if kind == "strings" else 0)
+            shdr["entsize"] = entsize
+            marked += 1
+    if marked == 0:
+        print(f"no section starting with {prefix} in {src}")
+        return 1
+    with open(dst, "w") as f:
+        json.dump(obj, f, indent=4, ensure_ascii=False)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
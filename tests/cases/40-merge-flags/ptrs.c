@@ -0,0 +1,10 @@
+#include "minilibc.h"
+
+extern const char* const ptrs_a[1];
+extern const char* const ptrs_b[1];
+
+int main(void)
+{
+    printf("%d %d\n", ptrs_a[0][0], ptrs_b[0][0]);
+    return 0;
+}
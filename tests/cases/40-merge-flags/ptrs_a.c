@@ -0,0 +1,3 @@
+// 只有一个指针的表：原始字节全是 0，指向哪里全靠重定位
+static const char text_a[] = "A";
+const char* const ptrs_a[1] = { text_a };
@@ -0,0 +1,2 @@
+static const char text_b[] = "B";
+const char* const ptrs_b[1] = { text_b };
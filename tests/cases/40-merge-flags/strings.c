@@ -0,0 +1,13 @@
+// 3 字节的普通只读数据排在合并块前面，合并块要自己按 8 字节对齐
+const char odd_tag[3] = "ab";
+
+// -O2 时这两个长字符串放进 .rodata.str1.8，每个都按 8 字节对齐
+const char* long_a(void)
+{
+    return "a fairly long string literal that gcc aligns to eight bytes";
+}
+
+const char* long_b(void)
+{
+    return "another fairly long string literal aligned by gcc to eight";
+}
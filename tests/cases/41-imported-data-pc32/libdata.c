@@ -0,0 +1,3 @@
+int shared_counter = 7;
+
+int get_counter(void) { return shared_counter; }
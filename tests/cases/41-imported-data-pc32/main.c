@@ -0,0 +1,4 @@
+// 不用 -fPIC 编译：对共享库里变量的访问是 PC32，而数据没有 PLT 表项
+extern int shared_counter;
+
+int main(void) { return shared_counter; }